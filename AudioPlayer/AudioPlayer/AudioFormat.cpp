@@ -0,0 +1,54 @@
+#include "AudioFormat.h"
+#include <QFile>
+#include <QFileInfo>
+
+bool AudioFormat::isMpegFrame(const unsigned char* bytes)
+{
+    // 11 بت مزامنة، ثم رفض القيم المحجوزة (الإصدار، الطبقة، معدل البت، معدل العينة)
+    if (bytes[0] != 0xFF || (bytes[1] & 0xE0) != 0xE0) return false;
+    if (((bytes[1] >> 3) & 0x3) == 0x1) return false;
+    if (((bytes[1] >> 1) & 0x3) == 0x0) return false;
+    if ((bytes[2] >> 4) == 0xF) return false;
+    if (((bytes[2] >> 2) & 0x3) == 0x3) return false;
+    return true;
+}
+
+AudioFormat::Type AudioFormat::fromHeader(const QByteArray& header)
+{
+    if (header.size() < 4) return Unknown;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(header.constData());
+
+    if (header.startsWith("fLaC")) return Flac;
+    if (header.size() >= 12 && (header.startsWith("RIFF") || header.startsWith("RF64")) && header.mid(8, 4) == "WAVE") return Wav;
+    // Wave64: "riff" ثم بقية GUID الخاص بها
+    if (header.size() >= 16 && header.startsWith("riff") && bytes[4] == 0x2E && bytes[5] == 0x91 && bytes[6] == 0xCF && bytes[7] == 0x11) return Wav;
+    if (header.startsWith("ID3")) return Mp3;
+    if (isMpegFrame(bytes)) return Mp3;
+    return Unknown;
+}
+
+AudioFormat::Type AudioFormat::detect(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return Unknown;
+
+    QByteArray header = file.read(HEADER_SIZE);
+    Type type = fromHeader(header);
+
+    // وسم ID3v2 قد يسبق FLAC أيضاً، فننظر لما بعده (الحجم بصيغة syncsafe: 7 بت لكل بايت)
+    if (header.startsWith("ID3") && header.size() >= 10) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(header.constData());
+        qint64 tagSize = (qint64(bytes[6] & 0x7F) << 21) | ((bytes[7] & 0x7F) << 14) | ((bytes[8] & 0x7F) << 7) | (bytes[9] & 0x7F);
+        qint64 audioStart = 10 + tagSize + ((bytes[5] & 0x10) ? 10 : 0);
+        if (file.seek(audioStart) && fromHeader(file.read(HEADER_SIZE)) == Flac) return Flac;
+        return Mp3;
+    }
+
+    if (type == Unknown && QFileInfo(filePath).suffix().compare("mp3", Qt::CaseInsensitive) == 0) return Mp3;
+    return type;
+}
+
+QString AudioFormat::dialogFilter()
+{
+    return "ملفات الصوت (*.mp3 *.wav *.flac);;كل الملفات (*)";
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <QString>
+#include <QByteArray>
+
+// --- التعرف على صيغ الصوت (AudioFormat) ---
+// الصيغ التي تفتحها miniaudio بدون مكتبات إضافية، ويُتعرف عليها من أول بايتات الملف
+// وليس من الامتداد (ملف FLAC باسم .mp3 أو بدون امتداد يُقبل، وصورة باسم .mp3 لا تُقبل).
+class AudioFormat {
+public:
+    enum Type {
+        Unknown,
+        Mp3,
+        Wav,
+        Flac
+    };
+
+    // أقل عدد بايتات تحتاجه fromHeader
+    static const int HEADER_SIZE = 16;
+
+    static Type fromHeader(const QByteArray& header);
+
+    // يقرأ ترويسة الملف (وما بعد وسم ID3 إن وجد). الامتداد يُستخدم فقط لملفات MP3
+    // التي لا تبدأ بإطار مباشرة (بعض الملفات فيها بيانات زائدة قبل أول إطار)
+    static Type detect(const QString& filePath);
+
+    // لنوافذ اختيار الملفات: "ملفات الصوت (*.mp3 *.wav *.flac)"
+    static QString dialogFilter();
+
+private:
+    static bool isMpegFrame(const unsigned char* bytes);
+};
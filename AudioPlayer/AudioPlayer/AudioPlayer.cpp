@@ -1,4 +1,5 @@
 #include "AudioPlayer.h"
+#include "LibraryIndex.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QStyle>
@@ -11,8 +12,77 @@
 #include <QIcon>
 #include <QMap>
 #include <QPainter>
+#include <QStyledItemDelegate>
+#include <QApplication>
+#include <QProgressDialog>
+#include <QElapsedTimer>
+#include <QMimeData>
+#include <QUrl>
+#include <QSet>
+#include <QMenu>
+#include <QAction>
+#include <QItemSelection>
+#include <QDialog>
+#include <QFormLayout>
+#include <QSpinBox>
+#include <QDialogButtonBox>
+#include <QDateTime>
+#include <algorithm>
 
 const QString BASE_PATH = "D:/QuranAudio/";
+// تنبيهات مراقب المكتبة تُجمع حتى يهدأ القرص، وأطول انتظار ممكن أثناء نسخ طويل
+static const int LIBRARY_QUIET_MS = 500;
+static const qint64 LIBRARY_MAX_DELAY_MS = 3000;
+// مجلدات لم يقبلها المراقب (حد inotify أو المقابض في النظام) تُفحص دورياً بوقت تعديلها
+static const int LIBRARY_POLL_MS = 30000;
+// السورة تُحسب مرة تشغيل بعد هذا القدر من الاستماع الفعلي (بدون القفز بالتقديم) أو عند اكتمالها،
+// فالتنقل السريع بالتالي/السابق لا يرفع مرات التشغيل
+static const qint64 PLAY_COUNT_MIN_MS = 30000;
+
+// يرسم رقم الصف أمام اسم السورة وقت العرض فقط،
+// فلا يحتاج حذف عنصر إلى إعادة ترقيم باقي العناصر.
+// المدة (إن عُرفت) في الطرف الآخر من الصف، والاسم يُختصر قبلها
+class NumberedItemDelegate : public QStyledItemDelegate
+{
+public:
+    using QStyledItemDelegate::QStyledItemDelegate;
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override
+    {
+        QString duration = index.data(PlaylistModel::DurationRole).toString();
+        if (duration.isEmpty()) {
+            QStyledItemDelegate::paint(painter, option, index);
+            return;
+        }
+
+        QStyleOptionViewItem opt = option;
+        initStyleOption(&opt, index);
+        const int margin = 6;
+        int durationWidth = opt.fontMetrics.horizontalAdvance(duration) + 2 * margin;
+        opt.text = opt.fontMetrics.elidedText(opt.text, opt.textElideMode, opt.rect.width() - durationWidth - 2 * margin);
+
+        const QWidget* widget = opt.widget;
+        QStyle* style = widget ? widget->style() : QApplication::style();
+        style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+
+        bool rightToLeft = opt.direction == Qt::RightToLeft;
+        QRect durationRect = opt.rect.adjusted(margin, 0, -margin, 0);
+        Qt::Alignment alignment = Qt::AlignVCenter | Qt::AlignAbsolute | (rightToLeft ? Qt::AlignLeft : Qt::AlignRight);
+        bool selected = opt.state & QStyle::State_Selected;
+
+        painter->save();
+        painter->setPen(opt.palette.color(selected ? QPalette::HighlightedText : QPalette::PlaceholderText));
+        painter->drawText(durationRect, int(alignment), duration);
+        painter->restore();
+    }
+
+protected:
+    void initStyleOption(QStyleOptionViewItem* option, const QModelIndex& index) const override
+    {
+        QStyledItemDelegate::initStyleOption(option, index);
+        option->text = QString::number(index.data(PlaylistModel::RowNumberRole).toInt()) + ". " + option->text;
+    }
+};
 
 void AudioPlayer::data_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount)
 {
@@ -34,20 +104,65 @@ AudioPlayer::AudioPlayer(QWidget* parent) : QWidget(parent)
     timer->setInterval(100);  // Check every 100ms
     connect(timer, &QTimer::timeout, this, &AudioPlayer::updateProgress);
 
+    // شرط "أضيفت مؤخراً" يُراجع كل ساعة
+    smartExpiryTimer = new QTimer(this);
+    smartExpiryTimer->setInterval(60 * 60 * 1000);
+    connect(smartExpiryTimer, &QTimer::timeout, this, &AudioPlayer::expireSmartPlaylists);
+    smartExpiryTimer->start();
+
+    scanner = new LibraryScanner(this);
+    connect(scanner, &LibraryScanner::filesFound, this, &AudioPlayer::scanFilesFound);
+    connect(scanner, &LibraryScanner::filesChanged, this, &AudioPlayer::scanFilesChanged);
+    connect(scanner, &LibraryScanner::filesRemoved, this, &AudioPlayer::scanFilesRemoved);
+    connect(scanner, &LibraryScanner::filesRenamed, this, &AudioPlayer::scanFilesRenamed);
+    connect(scanner, &LibraryScanner::rootMissing, this, &AudioPlayer::scanRootMissing);
+    connect(scanner, &LibraryScanner::finished, this, &AudioPlayer::scanFinished);
+
+    importPool.setMaxThreadCount(1);
+
+    metadataReader = new MetadataReader(this);
+    connect(metadataReader, &MetadataReader::tagsRead, this, &AudioPlayer::metadataRead);
+    connect(metadataReader, &MetadataReader::durationsRead, this, &AudioPlayer::durationsRead);
+
+    libraryWatcher = new QFileSystemWatcher(this);
+    connect(libraryWatcher, &QFileSystemWatcher::directoryChanged, this, &AudioPlayer::libraryDirectoryChanged);
+    rescanTimer = new QTimer(this);
+    rescanTimer->setSingleShot(true);
+    rescanTimer->setInterval(LIBRARY_QUIET_MS);
+    connect(rescanTimer, &QTimer::timeout, this, &AudioPlayer::rescanDirtyDirectories);
+    pollTimer = new QTimer(this);
+    pollTimer->setInterval(LIBRARY_POLL_MS);
+    connect(pollTimer, &QTimer::timeout, this, &AudioPlayer::pollUnwatchedDirectories);
+
     setupUi();
+    connect(&TrackCatalog::instance(), &TrackCatalog::trackAdded, this, &AudioPlayer::trackAdded);
+    connect(&TrackCatalog::instance(), &TrackCatalog::trackChanged, this, &AudioPlayer::trackChanged);
     setupDefaultPlaylists();
+    restoreSmartPlaylists();
     updateUiState();
 
-    if (!allPlaylists.isEmpty()) {
+    // فحص المكتبة عند البدء ليس تعديلاً من المستخدم
+    journal.clear();
+
+    if (!playlists.isEmpty()) {
         playlistSelector->setCurrentIndex(0);
     }
 }
 
 AudioPlayer::~AudioPlayer()
 {
+    importsCanceled.storeRelease(1);
+    importPool.waitForDone();
+    // فحص لم يكتمل يُلغى ولا تُحفظ نتيجته، لكن القوائم تُحفظ في library.index
+    // ببصمة library.cache الموجود على القرص، فالجلسة القادمة تفحص الفرق عنه
+    bool scanning = scanner->isScanning();
+    scanner->cancel();
+    if (scanning || !libraryCache) saveLibraryIndex();
+    else saveLibraryCache();
+    saveSmartPlaylists();
     stopClicked();
-    for (auto it = allPlaylists.begin(); it != allPlaylists.end(); ++it) {
-        deleteList(it.value());
+    for (int i = 0; i < playlists.count(); ++i) {
+        deleteList(*playlists.get(playlists.idAt(i)));
     }
 }
 
@@ -56,6 +171,15 @@ void AudioPlayer::keyPressEvent(QKeyEvent* event)
     // Check for lowercase letters by getting the text
     QString keyText = event->text().toLower();
 
+    if (event->matches(QKeySequence::Undo)) {
+        undoClicked();
+        return;
+    }
+    else if (event->matches(QKeySequence::Redo)) {
+        redoClicked();
+        return;
+    }
+
     if (keyText == "p") {
         playPauseClicked();
         return;
@@ -64,6 +188,18 @@ void AudioPlayer::keyPressEvent(QKeyEvent* event)
         restartClicked();
         return;
     }
+    else if (keyText == "s") {
+        shuffleBtn->toggle();
+        return;
+    }
+    else if (keyText == "q") {
+        enqueueSelectedClicked();
+        return;
+    }
+    else if (keyText == "n") {
+        playNextSelectedClicked();
+        return;
+    }
 
     // Handle other keys
     switch (event->key()) {
@@ -91,69 +227,499 @@ void AudioPlayer::setupDefaultPlaylists()
 {
     const QString defaultPlaylistName = "الافتراضية";
 
-    if (allPlaylists.isEmpty())
+    if (playlists.isEmpty() && restoreLibraryIndex()) {
+        // library.cache يُقرأ على خيط الفحص، والقوائم ظاهرة من الفهرس.
+        // فهرس لم يُكتب مع library.cache الحالي: فحص كامل بدونه
+        libraryFromIndex = true;
+        if (libraryIndexStale) scanner->start(QStringList() << BASE_PATH);
+        else scanner->start(QStringList() << BASE_PATH, LibraryCache::defaultPath());
+        statusLabel->setText("جاري فحص المكتبة...");
+    }
+
+    if (playlists.isEmpty())
     {
-        Playlist defaultList = { defaultPlaylistName, nullptr, nullptr, "" };
-        allPlaylists.insert(defaultPlaylistName, defaultList);
+        QSharedPointer<Playlist> defaultList(new Playlist);
+        defaultList->name = defaultPlaylistName;
+        playlists.add(defaultList);
+
+        activePlaylist = defaultList;
+
+        // القائمة تظهر من الفهرس المحفوظ فوراً، والفحص يطبق الفرق فقط.
+        // حتى التحقق من وجود المجلد قد يتأخر على قرص شبكة، فكله في الخلفية
+        scanPlaylistId = defaultList->id;
+        loadLibraryCache(*defaultList);
+        scanner->start(QStringList() << BASE_PATH, libraryCache);
+        statusLabel->setText("جاري فحص المكتبة...");
+    }
 
-        activePlaylist = &allPlaylists[defaultPlaylistName];
+    playlistSelector->clear();
+    for (int i = 0; i < playlists.count(); ++i) {
+        QSharedPointer<Playlist> list = playlists.get(playlists.idAt(i));
+        playlistSelector->addItem(QIcon(list->iconPath), list->name, list->id);
+    }
+}
+
+void AudioPlayer::scanFilesFound(const QStringList& paths)
+{
+    QSharedPointer<Playlist> list = playlists.get(scanPlaylistId);
+    if (!list) return;
+
+    PathTable& table = PathTable::instance();
+    TrackCatalog& catalog = TrackCatalog::instance();
+    QVector<PathId> newIds;
+    newIds.reserve(paths.size());
+    QSet<PathId> seen;
+
+    for (const QString& path : paths) {
+        PathId pathId = catalog.add(path);
+        PathId canonical = table.canonicalId(pathId);
+        if (list->containsPath(pathId) || seen.contains(canonical)) continue;
+
+        seen.insert(canonical);
+        newIds.append(pathId);
+    }
+
+    // الفحص ليس تعديلاً من المستخدم فلا يُسجل في سجل التراجع،
+    // والإضافة في آخر القائمة لا تغير أرقام الصفوف التي يشير إليها السجل
+    insertRows(*list, list->count(), newIds);
+    scheduleSmartChanges();
+
+    if (scanner->isScanning() && !partialScan) {
+        statusLabel->setText(QString("جاري فحص المكتبة... %1 سورة").arg(scanner->stats().fileCount));
+    }
+}
+
+int AudioPlayer::loadLibraryCache(Playlist& list)
+{
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    QSharedPointer<LibraryCache> cache(new LibraryCache);
+    if (!cache->load(LibraryCache::defaultPath())) return 0;
+    libraryCache = cache;
+
+    int added = addCachedTracks(list, *libraryCache);
+
+    qDebug() << "Library cache:" << added << "tracks in" << libraryCache->directoryCount()
+        << "folders loaded in" << elapsed.elapsed() << "ms";
+    return added;
+}
 
-        QDir audioDir(BASE_PATH);
-        if (!audioDir.exists()) {
-            QMessageBox::warning(this, "تنبيه", "مسار الصوت الافتراضي غير موجود: " + BASE_PATH);
+int AudioPlayer::addCachedTracks(Playlist& list, const LibraryCache& cache)
+{
+    const PathTable& table = PathTable::instance();
+    TrackCatalog& catalog = TrackCatalog::instance();
+    QVector<LibraryCache::Track> tracks = cache.tracks(BASE_PATH);
+    QVector<PathId> pathIds;
+    pathIds.reserve(tracks.size());
+
+    for (const LibraryCache::Track& track : tracks) {
+        const LibraryCache::FileRecord& record = track.record;
+        // ما استعيد من LibraryIndex أو عرفته الجلسة بالفعل بياناته أحدث من السجل
+        PathId known = table.find(track.path);
+        bool isNew = known == INVALID_PATH_ID || catalog.info(known).addedAt == 0;
+
+        PathId pathId = catalog.add(track.path, record.addedAt, record.playCount);
+        if (isNew) {
+            catalog.setFileSize(pathId, record.size);
+            if (record.durationMs >= 0) catalog.setDuration(pathId, record.durationMs);
+            // السور التي لم تُقرأ وسومها بعد تُرسل لـ MetadataReader عبر trackAdded
+            if (record.tagsRead) catalog.setTags(pathId, record.title, record.reciter, record.album, record.surahNumber);
         }
-        else {
-            QStringList filters;
-            filters << "*.mp3";
-            QFileInfoList fileList = audioDir.entryInfoList(filters, QDir::Files | QDir::Readable, QDir::Name);
+        if (!list.containsPath(pathId)) pathIds.append(pathId);
+    }
+    insertRows(list, list.count(), pathIds);
+    return pathIds.size();
+}
 
-            for (const QFileInfo& fileInfo : fileList) {
-                addSurahToActiveList(fileInfo.fileName(), fileInfo.absoluteFilePath(), true);
+void AudioPlayer::saveLibraryCache()
+{
+    if (!libraryCache) return;
+
+    // نسخة لأن الفحص الجاري (إن وجد) يقرأ libraryCache من خيوط أخرى
+    LibraryCache snapshot = *libraryCache;
+    snapshot.updateDerived(TrackCatalog::instance());
+    if (!snapshot.save(LibraryCache::defaultPath())) {
+        qDebug() << "Could not save library cache to" << LibraryCache::defaultPath();
+    }
+    // بعد library.cache دائماً حتى يحمل الفهرس بصمة الملف الذي سيُقرأ معه في الجلسة القادمة
+    saveLibraryIndex();
+}
+
+bool AudioPlayer::restoreLibraryIndex()
+{
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    LibraryIndex index;
+    if (!index.open(LibraryIndex::defaultPath()) || index.playlistCount() == 0) return false;
+    // الفهرس لم يُكتب مع library.cache الحالي: القوائم تُستعاد منه، لكن الفحص لا يقارن
+    // بحالة غير التي حُفظت معه، بل يفحص كل شيء (انظر scanFinished)
+    QString cachePath = LibraryCache::defaultPath();
+    libraryIndexStale = !QFileInfo::exists(cachePath) || !index.matchesCache(cachePath);
+
+    QVector<PathId> pathIds = TrackCatalog::instance().restore(index);
+    if (pathIds.size() != index.trackCount()) return false;
+
+    for (int i = 0; i < index.playlistCount(); ++i) {
+        const LibraryIndex::PlaylistRecord& record = index.playlist(i);
+        QSharedPointer<Playlist> list(new Playlist);
+        list->name = index.text(record.name);
+        list->iconPath = index.text(record.iconPath);
+        playlists.add(list);
+
+        const quint32* trackIndexes = index.playlistTracks(i);
+        QVector<PathId> rows;
+        rows.reserve(int(record.trackCount));
+        for (quint32 row = 0; row < record.trackCount; ++row) {
+            rows.append(pathIds[int(trackIndexes[row])]);
+        }
+        insertRows(*list, 0, rows);
+
+        if (!activePlaylist) activePlaylist = list;
+        if (record.flags & LibraryIndex::LibraryPlaylist) scanPlaylistId = list->id;
+    }
+    if (scanPlaylistId == INVALID_PLAYLIST_ID) scanPlaylistId = activePlaylist->id;
+
+    // توحيد المسارات وفهرس البحث يُبنيان في الخلفية بعد ظهور النافذة
+    QTimer::singleShot(0, this, [this, pathIds]() {
+        buildRestoredIndexes(pathIds);
+    });
+
+    // restore لا يرسل trackAdded: ما لم تُعرف وسومه أو مدته بعد يُرسل لـ MetadataReader من هنا
+    pendingMetadata += pathIds;
+    if (!metadataScheduled && !pendingMetadata.isEmpty()) {
+        metadataScheduled = true;
+        QTimer::singleShot(0, this, &AudioPlayer::readPendingMetadata);
+    }
+
+    qDebug() << "Library index:" << pathIds.size() << "tracks in" << index.playlistCount()
+        << "playlists restored in" << elapsed.elapsed() << "ms";
+    return true;
+}
+
+void AudioPlayer::buildRestoredIndexes(const QVector<PathId>& pathIds)
+{
+    // نسخة خاصة من نفس الملف على خيط importPool، والجداول المشتركة لا تُلمس إلا عند التسليم
+    QString indexPath = LibraryIndex::defaultPath();
+    importPool.start([this, indexPath, pathIds]() {
+        QElapsedTimer elapsed;
+        elapsed.start();
+        LibraryIndex index;
+        if (!index.open(indexPath)) return;
+
+        QSharedPointer<TrackCatalog::RestoredIndexes> indexes(
+            new TrackCatalog::RestoredIndexes(TrackCatalog::buildRestoredIndexes(index, pathIds)));
+        qint64 buildMs = elapsed.elapsed();
+        if (importsCanceled.loadAcquire()) return;
+
+        QMetaObject::invokeMethod(this, [indexes, buildMs]() {
+            TrackCatalog::instance().adoptRestoredIndexes(*indexes);
+            qDebug() << "Library index: paths and search index built in the background in" << buildMs << "ms";
+        }, Qt::QueuedConnection);
+    });
+}
+
+void AudioPlayer::saveLibraryIndex()
+{
+    // القوائم الذكية تُبنى من شروطها، فلا تُحفظ سورها
+    TrackCatalog& catalog = TrackCatalog::instance();
+    QVector<LibraryIndex::PlaylistSnapshot> snapshots;
+    for (int i = 0; i < playlists.count(); ++i) {
+        PlaylistId id = playlists.idAt(i);
+        if (smartLists.isSmart(id)) continue;
+        QSharedPointer<Playlist> list = playlists.get(id);
+
+        LibraryIndex::PlaylistSnapshot snapshot;
+        snapshot.name = list->name;
+        snapshot.iconPath = list->iconPath;
+        snapshot.library = id == scanPlaylistId;
+        snapshot.tracks.reserve(list->count());
+        for (SurahNode* node = list->head; node != nullptr; node = node->next) {
+            snapshot.tracks.append(catalog.trackOf(node->pathId));
+        }
+        snapshots.append(snapshot);
+    }
+
+    // فحص كامل لم يكتمل بعد فهرس قديم: بصمة فارغة حتى لا يُطابق library.cache القديم
+    QString cachePath = libraryIndexStale ? QString() : LibraryCache::defaultPath();
+    if (!LibraryIndex::write(LibraryIndex::defaultPath(), snapshots, catalog, cachePath)) {
+        qDebug() << "Could not save library index to" << LibraryIndex::defaultPath();
+    }
+}
+
+QStringList AudioPlayer::missingLibraryTracks(const LibraryCache& cache) const
+{
+    const PathTable& table = PathTable::instance();
+    QSet<PathId> onDisk;
+    for (const LibraryCache::Track& track : cache.tracks(BASE_PATH)) {
+        PathId pathId = table.find(track.path);
+        if (pathId != INVALID_PATH_ID) onDisk.insert(table.canonicalId(pathId));
+    }
+
+    QSet<PathId> seen;
+    QStringList missing;
+    for (int i = 0; i < playlists.count(); ++i) {
+        PlaylistId id = playlists.idAt(i);
+        if (smartLists.isSmart(id)) continue;
+        QSharedPointer<Playlist> list = playlists.get(id);
+        for (SurahNode* node = list->head; node != nullptr; node = node->next) {
+            PathId trackId = table.canonicalId(node->pathId);
+            if (onDisk.contains(trackId) || seen.contains(trackId)) continue;
+            seen.insert(trackId);
+            QString path = table.path(node->pathId);
+            if (LibraryCache::isUnder(path, BASE_PATH)) missing.append(path);
+        }
+    }
+    return missing;
+}
+
+// تجميع صفوف مرتبة تصاعدياً في مجالات متتالية (start, count)
+static QVector<QPair<int, int>> groupRanges(const QList<int>& rows)
+{
+    QVector<QPair<int, int>> ranges;
+    for (int row : rows) {
+        if (!ranges.isEmpty() && ranges.last().first + ranges.last().second == row) ranges.last().second++;
+        else ranges.append(qMakePair(row, 1));
+    }
+    return ranges;
+}
+
+void AudioPlayer::scanFilesChanged(const QStringList& paths)
+{
+    // الملف تغير على القرص: المدة والوسوم القديمة لم تعد صالحة
+    TrackCatalog& catalog = TrackCatalog::instance();
+    QVector<PathId> pathIds;
+    for (const QString& path : paths) {
+        PathId pathId = PathTable::instance().find(path);
+        if (pathId == INVALID_PATH_ID) continue;
+        catalog.invalidate(pathId);
+        pathIds.append(pathId);
+    }
+    metadataReader->readTags(pathIds);
+    metadataReader->readDurations(pathIds);
+}
+
+void AudioPlayer::scanFilesRemoved(const QStringList& paths)
+{
+    // الملف لم يعد على القرص: يخرج من الفهرس ومن كل القوائم العادية (بكل نسخه فيها)،
+    // والقوائم الذكية تخرجه عبر trackRemoved
+    const PathTable& table = PathTable::instance();
+    TrackCatalog& catalog = TrackCatalog::instance();
+    QVector<TrackId> trackIds;
+    trackIds.reserve(paths.size());
+    for (const QString& path : paths) {
+        PathId pathId = table.find(path);
+        if (pathId == INVALID_PATH_ID) continue;
+        TrackId trackId = table.canonicalId(pathId);
+        smartLists.trackRemoved(trackId);
+        catalog.retire(trackId);
+        trackIds.append(trackId);
+    }
+
+    for (int i = 0; i < playlists.count(); ++i) {
+        PlaylistId id = playlists.idAt(i);
+        if (smartLists.isSmart(id)) continue;
+        QSharedPointer<Playlist> list = playlists.get(id);
+
+        QList<int> rows;
+        for (TrackId trackId : trackIds) {
+            for (auto it = list->pathIndex.constFind(trackId); it != list->pathIndex.constEnd() && it.key() == trackId; ++it) {
+                rows.append(list->indexOf(it.value()));
             }
         }
+        if (rows.isEmpty()) continue;
+        std::sort(rows.begin(), rows.end());
+
+        // من الأسفل للأعلى حتى لا تتغير أرقام المجالات المتبقية
+        QVector<QPair<int, int>> ranges = groupRanges(rows);
+        bool batched = isDisplayed(*list) && ranges.size() > 1;
+        if (batched) playlistModel->beginBatch();
+        for (int j = ranges.size() - 1; j >= 0; --j) {
+            removeRows(*list, ranges[j].first, ranges[j].second);
+        }
+        if (batched) playlistModel->endBatch();
     }
+    scheduleSmartChanges();
+}
 
-    playlistSelector->clear();
-    for (auto it = allPlaylists.constBegin(); it != allPlaylists.constEnd(); ++it) {
-        playlistSelector->addItem(QIcon(it.value().iconPath), it.key());
+void AudioPlayer::scanFilesRenamed(const QStringList& oldPaths, const QStringList& newPaths)
+{
+    // العقدة نفسها تأخذ المسار الجديد في كل القوائم، فتبقى في مكانها وفي الطابور
+    // وفي ترتيب الخلط، والسورة التي تُشغل الآن لا تنقطع
+    const PathTable& table = PathTable::instance();
+    TrackCatalog& catalog = TrackCatalog::instance();
+
+    for (int i = 0; i < oldPaths.size(); ++i) {
+        PathId oldPathId = table.find(oldPaths[i]);
+        if (oldPathId == INVALID_PATH_ID) continue;
+        TrackId oldTrackId = table.canonicalId(oldPathId);
+        PathId newPathId = catalog.rename(oldPathId, newPaths[i]);
+        journal.repath(oldTrackId, newPathId);
+
+        for (int j = 0; j < playlists.count(); ++j) {
+            QSharedPointer<Playlist> list = playlists.get(playlists.idAt(j));
+            QVector<SurahNode*> nodes;
+            for (auto it = list->pathIndex.constFind(oldTrackId);
+                it != list->pathIndex.constEnd() && it.key() == oldTrackId; ++it) {
+                nodes.append(it.value());
+            }
+            for (SurahNode* node : nodes) {
+                list->repath(node, newPathId);
+                if (list == activePlaylist) playlistModel->refreshRow(list->indexOf(node));
+            }
+        }
+        // الاسم الجديد للملف قد يطابق البحث الحالي أو لا يطابقه
+        playlistModel->refilterTrack(table.canonicalId(newPathId));
+
+        // القوائم الذكية تضم الرقم الجديد (trackAdded) وتخرج القديم، والعقدة موجودة بالفعل.
+        // تغيير حالة الأحرف فقط على Windows يبقي نفس الرقم
+        if (table.canonicalId(newPathId) != oldTrackId) smartLists.trackRemoved(oldTrackId);
     }
+    scheduleSmartChanges();
 }
 
-void AudioPlayer::addSurahToActiveList(QString name, QString filename, bool isAbsolutePath)
+void AudioPlayer::scanRootMissing(const QString& root)
 {
-    if (!activePlaylist) return;
+    // مجلد فرعي حُذف بعد تنبيه المراقب ليس خطأ، وملفاته تصل في filesRemoved
+    if (QDir::cleanPath(root) != QDir::cleanPath(BASE_PATH)) return;
+    QMessageBox::warning(this, "تنبيه", "مسار الصوت الافتراضي غير موجود: " + root);
+}
 
-    SurahNode* newNode = new SurahNode;
-    newNode->name = name;
-    newNode->path = isAbsolutePath ? filename : (BASE_PATH + filename);
-    newNode->next = nullptr;
-    newNode->prev = nullptr;
+void AudioPlayer::scanFinished()
+{
+    const LibraryScanner::Stats& stats = scanner->stats();
+    double seconds = qMax(stats.elapsedMs / 1000.0, 1e-3);
+    qDebug() << "Library scan:" << stats.fileCount << "new files in" << stats.directoryCount << "folders,"
+        << stats.elapsedMs << "ms (" << int(stats.fileCount / seconds) << "files/s ), first track after"
+        << stats.firstBatchMs << "ms," << stats.skippedCount << "non-audio files skipped";
+    qDebug() << "Library cache reuse:" << stats.reusedDirectories << "of" << stats.directoryCount
+        << "folders unchanged," << stats.sniffedCount << "files opened";
+
+    libraryCache = scanner->result();
+    updateLibraryWatch();
+    // تنبيهات وصلت أثناء الفحص
+    if (!dirtyDirectories.isEmpty()) rescanTimer->start();
+
+    // الفحص الجزئي لا يُحفظ في كل مرة، والملفان يُحفظان عند الإغلاق
+    if (partialScan) {
+        partialScan = false;
+        qDebug() << "Library update:" << stats.fileCount << "new files," << stats.sniffedCount << "files opened in"
+            << stats.directoryCount << "folders," << stats.elapsedMs << "ms";
+        return;
+    }
+    // القوائم جاءت من LibraryIndex: سور library.cache التي ليست فيه تُضاف كما في loadLibraryCache
+    if (libraryFromIndex) {
+        libraryFromIndex = false;
+        if (libraryIndexStale) {
+            // الفحص الكامل أضاف كل ما على القرص، وما في القوائم وليس في نتيجته حُذف
+            libraryIndexStale = false;
+            scanFilesRemoved(missingLibraryTracks(*libraryCache));
+        }
+        else if (QSharedPointer<Playlist> list = playlists.get(scanPlaylistId)) {
+            addCachedTracks(*list, *libraryCache);
+        }
+    }
+    // السور الجديدة وما استعيد من LibraryIndex بدون حجم
+    libraryCache->updateFileSizes(TrackCatalog::instance());
+    saveLibraryCache();
+
+    statusLabel->setText(QString("تم فحص المكتبة: %1 سورة جديدة في %2 ثانية")
+        .arg(stats.fileCount).arg(stats.elapsedMs / 1000.0, 0, 'f', 1));
+}
 
-    if (activePlaylist->head == nullptr) {
-        activePlaylist->head = newNode;
-        activePlaylist->tail = newNode;
+// مجلد داخل مجلد آخر من paths يُفحص معه، فتبقى المجلدات العليا فقط
+static QStringList topDirectories(QStringList paths)
+{
+    std::sort(paths.begin(), paths.end());
+    QStringList roots;
+    for (const QString& path : paths) {
+        if (roots.isEmpty() || !LibraryCache::isUnder(path, roots.last())) roots.append(path);
     }
-    else {
-        activePlaylist->tail->next = newNode;
-        newNode->prev = activePlaylist->tail;
-        activePlaylist->tail = newNode;
+    return roots;
+}
+
+void AudioPlayer::updateLibraryWatch()
+{
+    if (!libraryCache) return;
+
+    QStringList watched = libraryWatcher->directories();
+    QSet<QString> wanted;
+    for (const QString& path : libraryCache->directoryPaths()) {
+        wanted.insert(path);
+    }
+
+    QStringList stale;
+    QSet<QString> existing;
+    for (const QString& path : watched) {
+        if (wanted.contains(path)) existing.insert(path);
+        else stale.append(path);
+    }
+    QStringList added;
+    for (const QString& path : wanted) {
+        if (!existing.contains(path)) added.append(path);
     }
 
-    if (activePlaylist->name == playlistSelector->currentText()) {
-        playlistWidget->addItem(QString::number(playlistWidget->count() + 1) + ". " + name);
+    if (!stale.isEmpty()) libraryWatcher->removePaths(stale);
+    QStringList failed;
+    if (!added.isEmpty()) failed = libraryWatcher->addPaths(added);
+
+    // ما رفضه النظام (حد المراقبة) لا تصل منه تنبيهات: يُفحص كل LIBRARY_POLL_MS، وفي كل
+    // تحديث للمراقبة يُعاد طلبه (قد يكون حُذف غيره من المراقبة)
+    if (failed.size() != unwatchedDirectories.size()) {
+        qDebug() << "Library watch:" << failed.size() << "of" << wanted.size()
+            << "folders could not be watched, checked every" << LIBRARY_POLL_MS / 1000 << "s";
+    }
+    unwatchedDirectories = failed;
+    if (unwatchedDirectories.isEmpty()) pollTimer->stop();
+    else if (!pollTimer->isActive()) pollTimer->start();
+
+    // مجلد جديد لم يكن مراقباً بين قراءته وإضافته للمراقب (نسخ ما زال جارياً)،
+    // فيُقرأ مرة أخرى، وملفاته التي لم تتغير تُؤخذ من الفهرس
+    // (ما لم يقبله المراقب يبقى للفحص الدوري، وإلا أعاد كل فحص فحصه بلا نهاية)
+    if (!watched.isEmpty()) {
+        QSet<QString> rejected(failed.constBegin(), failed.constEnd());
+        for (const QString& path : added) {
+            if (!rejected.contains(path)) libraryDirectoryChanged(path);
+        }
     }
 }
 
+void AudioPlayer::pollUnwatchedDirectories()
+{
+    // فحص جارٍ يكمل أولاً، والمحاولة التالية بعد LIBRARY_POLL_MS
+    if (unwatchedDirectories.isEmpty() || scanner->isScanning()) return;
+
+    // بدون إعادة قراءة المجلدات نفسها: ما لم يتغير وقت تعديله يُؤخذ من الفهرس
+    partialScan = true;
+    scanner->start(topDirectories(unwatchedDirectories), libraryCache);
+}
+
+void AudioPlayer::libraryDirectoryChanged(const QString& path)
+{
+    dirtyDirectories.insert(QDir::cleanPath(path));
+
+    // كل تنبيه يؤجل الفحص حتى يهدأ القرص، لكن ليس أكثر من LIBRARY_MAX_DELAY_MS
+    if (!dirtySince.isValid()) dirtySince.start();
+    if (!rescanTimer->isActive() || dirtySince.elapsed() < LIBRARY_MAX_DELAY_MS) rescanTimer->start();
+}
+
+void AudioPlayer::rescanDirtyDirectories()
+{
+    if (dirtyDirectories.isEmpty()) return;
+    // فحص جارٍ (كامل أو جزئي) يكمل أولاً، و scanFinished يعيد المحاولة
+    if (scanner->isScanning()) return;
+
+    QStringList roots = topDirectories(dirtyDirectories.values());
+    dirtyDirectories.clear();
+    dirtySince.invalidate();
+    partialScan = true;
+    scanner->start(roots, libraryCache, true);
+}
+
 void AudioPlayer::deleteList(Playlist& list)
 {
-    SurahNode* current = list.head;
-    while (current != nullptr) {
-        SurahNode* nextNode = current->next;
-        delete current;
-        current = nextNode;
-    }
-    list.head = nullptr;
-    list.tail = nullptr;
+    list.clear();
 }
 
 void AudioPlayer::setupUi()
@@ -168,18 +734,18 @@ void AudioPlayer::setupUi()
             font-size: 14px; 
             font-family: 'Segoe UI', sans-serif; 
         }
-        QListWidget { 
+        QListView { 
             background-color: #252537; 
             border-radius: 10px; 
             padding: 5px; 
             font-size: 16px; 
             border: 1px solid #303040; 
         }
-        QListWidget::item { 
+        QListView::item { 
             padding: 8px; 
             border-bottom: 1px solid #303040; 
         }
-        QListWidget::item:selected { 
+        QListView::item:selected { 
             background-color: #89b4fa; 
             color: #1e1e2e; 
             border-radius: 5px; 
@@ -226,6 +792,7 @@ void AudioPlayer::setupUi()
         }
     )";
     setStyleSheet(cssStyle);
+    setAcceptDrops(true);
 
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
     mainLayout->setSpacing(15);
@@ -290,6 +857,12 @@ void AudioPlayer::setupUi()
     nextBtn->setIconSize(QSize(20, 20));
     nextBtn->setStyleSheet("border-radius: 15px;");
 
+    shuffleBtn = new QPushButton("🔀", this);
+    shuffleBtn->setCheckable(true);
+    shuffleBtn->setFixedSize(30, 30);
+    shuffleBtn->setToolTip("تشغيل عشوائي");
+    shuffleBtn->setStyleSheet("QPushButton { border-radius: 15px; padding: 0px; } QPushButton:checked { background-color: #89b4fa; }");
+
     stopBtn = new QPushButton(this);
 
     mainControlsLayout->addStretch();
@@ -297,6 +870,7 @@ void AudioPlayer::setupUi()
     mainControlsLayout->addWidget(restartBtn);
     mainControlsLayout->addWidget(playBtn);
     mainControlsLayout->addWidget(nextBtn);
+    mainControlsLayout->addWidget(shuffleBtn);
     mainControlsLayout->addStretch();
 
     currentTimeLabel = new QLabel("00:00", this);
@@ -314,8 +888,11 @@ void AudioPlayer::setupUi()
     shortcutsLabel->setObjectName("ShortcutsLabel");
     shortcutsLabel->setText(
         "⌨️ اختصارات لوحة المفاتيح:\n"
-        "Space / p = تشغيل/إيقاف | r = إعادة\n"
-        "→ = التالي | ← = السابق | ↑ = رفع الصوت | ↓ = خفض الصوت"
+        "Space / p = تشغيل/إيقاف | r = إعادة | s = عشوائي\n"
+        "n = تشغيل تالياً | q = إضافة للطابور\n"
+        "Alt+↑ / Alt+↓ = نقل السور المحددة (أو اسحبها بالفأرة)\n"
+        "→ = التالي | ← = السابق | ↑ = رفع الصوت | ↓ = خفض الصوت\n"
+        "Ctrl+Z = تراجع | Ctrl+Y = إعادة التعديل | Ctrl+F = بحث"
     );
     shortcutsLabel->setAlignment(Qt::AlignCenter);
     shortcutsLabel->setWordWrap(true);
@@ -325,14 +902,58 @@ void AudioPlayer::setupUi()
     leftColumnLayout->addLayout(seekTimeLayout);
     leftColumnLayout->addWidget(shortcutsLabel);
 
-    playlistWidget = new QListWidget(this);
-    playlistWidget->setMinimumHeight(200);
-    connect(playlistWidget, &QListWidget::itemDoubleClicked, this, &AudioPlayer::onPlaylistDoubleClicked);
+    playlistModel = new PlaylistModel(this);
+    searchEdit = new QLineEdit(this);
+    searchEdit->setPlaceholderText("🔍 بحث في القائمة (Ctrl+F)");
+    searchEdit->setClearButtonEnabled(true);
+    connect(searchEdit, &QLineEdit::textChanged, this, &AudioPlayer::searchTextChanged);
+
+    QAction* findAction = new QAction(this);
+    findAction->setShortcut(QKeySequence::Find);
+    connect(findAction, &QAction::triggered, searchEdit, QOverload<>::of(&QWidget::setFocus));
+    addAction(findAction);
+
+    playlistView = new QListView(this);
+    playlistView->setModel(playlistModel);
+    playlistView->setMinimumHeight(200);
+    playlistView->setItemDelegate(new NumberedItemDelegate(playlistView));
+    playlistView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    playlistView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    // كل الصفوف بنفس الارتفاع: العرض لا يقيس 100 ألف صف، بل يحسب موضع الصفوف الظاهرة مباشرة
+    playlistView->setUniformItemSizes(true);
+    playlistView->setLayoutMode(QListView::Batched);
+    connect(playlistView, &QListView::doubleClicked, this, &AudioPlayer::onPlaylistDoubleClicked);
+    playlistView->setDragEnabled(true);
+    playlistView->setAcceptDrops(true);
+    playlistView->setDropIndicatorShown(true);
+    playlistView->setDragDropMode(QAbstractItemView::DragDrop);
+    playlistView->setDefaultDropAction(Qt::MoveAction);
+    playlistView->setDragDropOverwriteMode(false);
+    connect(playlistModel, &PlaylistModel::tracksDropped, this, &AudioPlayer::tracksDropped);
+
+    // اختصارات على القائمة نفسها لأن الأسهم وحدها تحرك التحديد داخلها
+    moveUpAction = new QAction("نقل لأعلى", playlistView);
+    moveUpAction->setShortcut(QKeySequence(Qt::ALT | Qt::Key_Up));
+    moveUpAction->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+    connect(moveUpAction, &QAction::triggered, this, &AudioPlayer::moveSelectedUpClicked);
+    playlistView->addAction(moveUpAction);
+
+    moveDownAction = new QAction("نقل لأسفل", playlistView);
+    moveDownAction->setShortcut(QKeySequence(Qt::ALT | Qt::Key_Down));
+    moveDownAction->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+    connect(moveDownAction, &QAction::triggered, this, &AudioPlayer::moveSelectedDownClicked);
+    playlistView->addAction(moveDownAction);
+
+    playlistView->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(playlistView, &QListView::customContextMenuRequested, this, &AudioPlayer::showPlaylistContextMenu);
 
     playerContainerLayout->addLayout(leftColumnLayout);
-    playerContainerLayout->addWidget(playlistWidget);
+    QVBoxLayout* playlistColumnLayout = new QVBoxLayout();
+    playlistColumnLayout->addWidget(searchEdit);
+    playlistColumnLayout->addWidget(playlistView);
+    playerContainerLayout->addLayout(playlistColumnLayout);
     playerContainerLayout->setStretchFactor(leftColumnLayout, 1);
-    playerContainerLayout->setStretchFactor(playlistWidget, 2);
+    playerContainerLayout->setStretchFactor(playlistColumnLayout, 2);
 
     mainLayout->addLayout(playerContainerLayout);
 
@@ -344,10 +965,34 @@ void AudioPlayer::setupUi()
     renamePlaylistBtn = new QPushButton("تغيير اسم القائمة", this);
     renamePlaylistBtn->setFixedWidth(150);
 
+    smartPlaylistBtn = new QPushButton("قائمة ذكية", this);
+    smartPlaylistBtn->setFixedWidth(120);
+    smartPlaylistBtn->setToolTip("قائمة تضم تلقائياً كل سورة تطابق شروطاً (المجلد، القارئ، المدة...)");
+
     selectorLayout->addWidget(new QLabel("قائمة التشغيل:", this));
     selectorLayout->addWidget(playlistSelector);
     selectorLayout->addWidget(createPlaylistBtn);
     selectorLayout->addWidget(renamePlaylistBtn);
+    selectorLayout->addWidget(smartPlaylistBtn);
+
+    QHBoxLayout* sortLayout = new QHBoxLayout();
+    sortSelector = new QComboBox(this);
+    sortSelector->addItem("الاسم", PlaylistSorter::ByName);
+    sortSelector->addItem("رقم السورة", PlaylistSorter::BySurahNumber);
+    sortSelector->addItem("المدة", PlaylistSorter::ByDuration);
+    sortSelector->addItem("حجم الملف", PlaylistSorter::ByFileSize);
+    sortSelector->addItem("تاريخ الإضافة", PlaylistSorter::ByDateAdded);
+    sortSelector->addItem("مرات التشغيل", PlaylistSorter::ByPlayCount);
+
+    sortDescendingBtn = new QPushButton("⇅", this);
+    sortDescendingBtn->setCheckable(true);
+    sortDescendingBtn->setFixedWidth(40);
+    sortDescendingBtn->setToolTip("ترتيب تنازلي");
+
+    sortLayout->addWidget(new QLabel("ترتيب حسب:", this));
+    sortLayout->addWidget(sortSelector);
+    sortLayout->addWidget(sortDescendingBtn);
+    sortLayout->addStretch();
 
     statusLabel = new QLabel("القائمة جاهزة", this);
     statusLabel->setAlignment(Qt::AlignCenter);
@@ -373,6 +1018,7 @@ void AudioPlayer::setupUi()
     controlsLayout->addWidget(deleteBtn);
 
     mainLayout->addLayout(selectorLayout);
+    mainLayout->addLayout(sortLayout);
     mainLayout->addWidget(statusLabel);
     mainLayout->addLayout(controlsLayout);
 
@@ -380,10 +1026,15 @@ void AudioPlayer::setupUi()
         this, &AudioPlayer::playlistSelectionChanged);
     connect(createPlaylistBtn, &QPushButton::clicked, this, &AudioPlayer::createNewPlaylistClicked);
     connect(renamePlaylistBtn, &QPushButton::clicked, this, &AudioPlayer::renamePlaylistClicked);
+    connect(smartPlaylistBtn, &QPushButton::clicked, this, &AudioPlayer::createSmartPlaylistClicked);
+    // activated وليس currentIndexChanged حتى يمكن إعادة نفس الترتيب بعد إضافة سور جديدة
+    connect(sortSelector, QOverload<int>::of(&QComboBox::activated), this, &AudioPlayer::sortRequested);
+    connect(sortDescendingBtn, &QPushButton::toggled, this, &AudioPlayer::sortOrderToggled);
     connect(seekSlider, &QSlider::sliderMoved, this, &AudioPlayer::seekTo);
     connect(playBtn, &QPushButton::clicked, this, &AudioPlayer::playPauseClicked);
     connect(stopBtn, &QPushButton::clicked, this, &AudioPlayer::stopClicked);
     connect(nextBtn, &QPushButton::clicked, this, &AudioPlayer::nextClicked);
+    connect(shuffleBtn, &QPushButton::toggled, this, &AudioPlayer::shuffleToggled);
     connect(prevBtn, &QPushButton::clicked, this, &AudioPlayer::prevClicked);
     connect(restartBtn, &QPushButton::clicked, this, &AudioPlayer::restartClicked);
 }
@@ -394,41 +1045,139 @@ void AudioPlayer::createNewPlaylistClicked()
     QString name = QInputDialog::getText(this, "إنشاء قائمة جديدة",
         "أدخل اسم قائمة التشغيل:", QLineEdit::Normal,
         "", &ok);
-    if (!ok || name.isEmpty() || allPlaylists.contains(name)) {
-        if (allPlaylists.contains(name)) QMessageBox::warning(this, "تنبيه", "هذه القائمة موجودة بالفعل.");
+    if (!ok || name.isEmpty() || playlists.contains(name)) {
+        if (playlists.contains(name)) QMessageBox::warning(this, "تنبيه", "هذه القائمة موجودة بالفعل.");
         return;
     }
 
     QString iconPath = QFileDialog::getOpenFileName(this, "اختر أيقونة للقائمة (اختياري)", "",
         "ملفات الصور (*.png *.jpg *.svg)");
 
-    allPlaylists.insert(name, { name, nullptr, nullptr, iconPath });
+    QSharedPointer<Playlist> newList(new Playlist);
+    newList->name = name;
+    newList->iconPath = iconPath;
+    PlaylistId id = playlists.add(newList);
 
-    playlistSelector->addItem(QIcon(iconPath), name);
-    playlistSelector->setCurrentText(name);
+    playlistSelector->addItem(QIcon(iconPath), name, id);
+    playlistSelector->setCurrentIndex(playlists.positionOf(id));
 }
 
-void AudioPlayer::renamePlaylist(const QString& oldName, const QString& newName) {
-    if (oldName == newName) return;
-    if (!allPlaylists.contains(oldName)) return;
+void AudioPlayer::createSmartPlaylistClicked()
+{
+    QDialog dialog(this);
+    dialog.setWindowTitle("إنشاء قائمة ذكية");
+
+    QLineEdit* nameEdit = new QLineEdit(&dialog);
+    QLineEdit* folderEdit = new QLineEdit(&dialog);
+    folderEdit->setPlaceholderText("أي مجلد");
+    QPushButton* browseBtn = new QPushButton("...", &dialog);
+    browseBtn->setFixedWidth(40);
+    connect(browseBtn, &QPushButton::clicked, &dialog, [&dialog, folderEdit]() {
+        QString folder = QFileDialog::getExistingDirectory(&dialog, "اختر المجلد", BASE_PATH);
+        if (!folder.isEmpty()) folderEdit->setText(folder);
+    });
+    QHBoxLayout* folderLayout = new QHBoxLayout();
+    folderLayout->addWidget(folderEdit);
+    folderLayout->addWidget(browseBtn);
+
+    QLineEdit* reciterEdit = new QLineEdit(&dialog);
+    reciterEdit->setPlaceholderText("أي قارئ");
+
+    // القيمة 0 في كل الحقول الرقمية = بدون شرط
+    QSpinBox* minMinutes = new QSpinBox(&dialog);
+    minMinutes->setRange(0, 600);
+    minMinutes->setSpecialValueText("بدون حد");
+    QSpinBox* maxMinutes = new QSpinBox(&dialog);
+    maxMinutes->setRange(0, 600);
+    maxMinutes->setSpecialValueText("بدون حد");
+    QSpinBox* minPlays = new QSpinBox(&dialog);
+    minPlays->setRange(0, 100000);
+    minPlays->setSpecialValueText("بدون شرط");
+    QSpinBox* addedDays = new QSpinBox(&dialog);
+    addedDays->setRange(0, 3650);
+    addedDays->setSpecialValueText("بدون شرط");
+
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    QFormLayout* form = new QFormLayout(&dialog);
+    form->addRow("اسم القائمة:", nameEdit);
+    form->addRow("المجلد:", folderLayout);
+    form->addRow("القارئ:", reciterEdit);
+    form->addRow("المدة من (دقيقة):", minMinutes);
+    form->addRow("المدة حتى (دقيقة):", maxMinutes);
+    form->addRow("مرات التشغيل على الأقل:", minPlays);
+    form->addRow("أضيفت خلال (يوم):", addedDays);
+    form->addRow(buttons);
+
+    if (dialog.exec() != QDialog::Accepted) return;
+
+    QString name = nameEdit->text().trimmed();
+    if (name.isEmpty() || playlists.contains(name)) {
+        if (playlists.contains(name)) QMessageBox::warning(this, "تنبيه", "هذه القائمة موجودة بالفعل.");
+        return;
+    }
 
-    bool wasActive = (activePlaylist && activePlaylist->name == oldName);
+    SmartRule rule;
+    rule.folder = folderEdit->text().trimmed();
+    rule.reciter = reciterEdit->text().trimmed();
+    if (minMinutes->value() > 0) rule.minDurationMs = minMinutes->value() * 60000;
+    if (maxMinutes->value() > 0) rule.maxDurationMs = maxMinutes->value() * 60000;
+    rule.minPlayCount = quint32(minPlays->value());
+    rule.addedWithinDays = addedDays->value();
 
-    Playlist listToRename = allPlaylists[oldName];
-    listToRename.name = newName;
+    PlaylistId id = addSmartPlaylist(name, rule);
+    playlistSelector->setCurrentIndex(playlists.positionOf(id));
+}
 
-    allPlaylists.remove(oldName);
-    allPlaylists.insert(newName, listToRename);
+PlaylistId AudioPlayer::addSmartPlaylist(const QString& name, const SmartRule& rule)
+{
+    QSharedPointer<Playlist> newList(new Playlist);
+    newList->name = name;
+    PlaylistId id = playlists.add(newList);
+    QVector<TrackId> members = smartLists.addList(id, rule);
+    insertRows(*newList, 0, members);
+
+    playlistSelector->addItem(QIcon(), name, id);
+    playlistSelector->setItemData(playlists.positionOf(id), rule.describe(), Qt::ToolTipRole);
+    return id;
+}
+
+void AudioPlayer::restoreSmartPlaylists()
+{
+    for (const SmartPlaylistEngine::SavedList& saved : SmartPlaylistEngine::load(SmartPlaylistEngine::defaultPath())) {
+        if (saved.name.isEmpty() || playlists.contains(saved.name)) continue;
+        addSmartPlaylist(saved.name, saved.rule);
+    }
+}
+
+void AudioPlayer::saveSmartPlaylists()
+{
+    QVector<SmartPlaylistEngine::SavedList> saved;
+    for (int i = 0; i < playlists.count(); ++i) {
+        PlaylistId id = playlists.idAt(i);
+        const SmartRule* rule = smartLists.rule(id);
+        if (rule == nullptr) continue;
+
+        SmartPlaylistEngine::SavedList list;
+        list.name = playlists.get(id)->name;
+        list.rule = *rule;
+        saved.append(list);
+    }
 
-    if (wasActive) {
-        activePlaylist = &allPlaylists[newName];
+    if (!SmartPlaylistEngine::save(SmartPlaylistEngine::defaultPath(), saved)) {
+        qDebug() << "Could not save smart playlists to" << SmartPlaylistEngine::defaultPath();
     }
+}
+
+void AudioPlayer::renamePlaylist(PlaylistId id, const QString& newName) {
+    if (!playlists.rename(id, newName)) return;
 
-    int index = playlistSelector->findText(oldName);
+    // موضع القائمة في playlistSelector معروف من السجل، فلا حاجة للبحث بالنص
+    int index = playlists.positionOf(id);
     if (index != -1) {
-        QIcon icon = playlistSelector->itemIcon(index);
         playlistSelector->setItemText(index, newName);
-        playlistSelector->setItemIcon(index, icon);
     }
 }
 
@@ -447,12 +1196,19 @@ void AudioPlayer::renamePlaylistClicked()
         oldName, &ok);
 
     if (ok && !newName.isEmpty() && newName != oldName) {
-        if (allPlaylists.contains(newName)) {
+        if (playlists.contains(newName)) {
             QMessageBox::warning(this, "تنبيه", "هذه القائمة موجودة بالفعل.");
             return;
         }
 
-        renamePlaylist(oldName, newName);
+        renamePlaylist(activePlaylist->id, newName);
+
+        PlaylistEdit edit;
+        edit.type = PlaylistEdit::RenamePlaylist;
+        edit.playlistId = activePlaylist->id;
+        edit.oldName = oldName;
+        edit.newName = newName;
+        journal.record(EditStep() << edit);
 
         statusLabel->setText("تم تغيير اسم القائمة إلى: " + newName);
     }
@@ -462,23 +1218,19 @@ void AudioPlayer::playlistSelectionChanged(int index)
 {
     if (index < 0) return;
 
-    QString name = playlistSelector->itemText(index);
+    QSharedPointer<Playlist> selected = playlists.get(playlists.idAt(index));
+    if (!selected) return;
 
-    if (!allPlaylists.contains(name)) return;
+    // التشغيل يستمر على playingPlaylist، فتغيير القائمة المعروضة لا يوقفه
+    activePlaylist = selected;
+    playlistModel->setPlaylist(activePlaylist);
 
-    stopClicked();
-    activePlaylist = &allPlaylists[name];
-    currentSurah = nullptr;
-
-    playlistWidget->clear();
-    SurahNode* current = activePlaylist->head;
-    int i = 1;
-    while (current != nullptr) {
-        playlistWidget->addItem(QString::number(i) + ". " + current->name);
-        current = current->next;
-        i++;
+    int playingRow = activePlaylist->indexOf(currentSurah);
+    if (playingRow >= 0) {
+        setCurrentRow(playingRow);
     }
-    statusLabel->setText("تم تحميل قائمة: " + name);
+    if (isSmartActive()) statusLabel->setText("قائمة ذكية: " + smartLists.rule(activePlaylist->id)->describe());
+    else statusLabel->setText("تم تحميل قائمة: " + activePlaylist->name);
     updateUiState();
 }
 
@@ -488,112 +1240,694 @@ void AudioPlayer::addSurahClicked()
         QMessageBox::warning(this, "تنبيه", "يجب إنشاء أو اختيار قائمة تشغيل أولاً.");
         return;
     }
+    if (isSmartActive()) {
+        QMessageBox::information(this, "قائمة ذكية",
+            "هذه القائمة تتحدث تلقائياً حسب شروطها:\n" + smartLists.rule(activePlaylist->id)->describe());
+        return;
+    }
 
-    QString filePath = QFileDialog::getOpenFileName(
+    QStringList filePaths = QFileDialog::getOpenFileNames(
         this,
-        "اختر ملف سورة (MP3)",
+        "اختر ملفات السور (MP3 / WAV / FLAC)",
         BASE_PATH,
-        "ملفات الصوت (*.mp3)"
+        AudioFormat::dialogFilter()
     );
 
-    if (filePath.isEmpty()) return;
+    if (filePaths.isEmpty()) return;
 
-    QFileInfo fileInfo(filePath);
+    int added = importFiles(activePlaylist, filePaths);
+    if (added == 0) {
+        QMessageBox::warning(this, "تنبيه", "الملفات المختارة مضافة بالفعل إلى القائمة.");
+        return;
+    }
 
-    QString baseName = fileInfo.fileName();
+    QMessageBox::information(this, "نجاح", QString("تمت إضافة %1 سورة بنجاح.").arg(added));
+}
 
-    SurahNode* current = activePlaylist->head;
-    while (current != nullptr) {
-        if (current->path == filePath) {
-            QMessageBox::warning(this, "تنبيه", "هذا الملف مضاف بالفعل إلى القائمة.");
-            return;
+QStringList AudioPlayer::collectAudioFiles(const QStringList& paths, const QAtomicInt& canceled)
+{
+    QStringList files;
+    for (const QString& path : paths) {
+        QFileInfo info(path);
+        if (info.isDir()) {
+            // المجلدات الفرعية أيضاً (القارئ/السورة)، وكل مجلد مرتب بالاسم
+            QStringList directories;
+            directories << info.absoluteFilePath();
+            while (!directories.isEmpty()) {
+                if (canceled.loadAcquire()) return QStringList();
+                QDir directory(directories.takeFirst());
+                QFileInfoList entries = directory.entryInfoList(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot | QDir::Readable, QDir::Name);
+                for (const QFileInfo& entry : entries) {
+                    if (entry.isDir()) {
+                        if (!entry.isSymLink()) directories.append(entry.absoluteFilePath());
+                    }
+                    else if (AudioFormat::detect(entry.absoluteFilePath()) != AudioFormat::Unknown) {
+                        files.append(entry.absoluteFilePath());
+                    }
+                }
+            }
+        }
+        else if (info.isFile() && AudioFormat::detect(info.absoluteFilePath()) != AudioFormat::Unknown) {
+            files.append(info.absoluteFilePath());
         }
-        current = current->next;
     }
+    return files;
+}
 
-    addSurahToActiveList(baseName, filePath, true);
+void AudioPlayer::importPaths(const QStringList& paths)
+{
+    if (!activePlaylist || paths.isEmpty()) return;
+
+    // قراءة المجلدات وفتح كل ملف لمعرفة صيغته قد يطول على قرص بطيء، فهو خارج الخيط الرئيسي،
+    // والسور تذهب للقائمة التي أُفلتت عليها ولو تغيرت القائمة المعروضة قبل انتهاء القراءة
+    PlaylistId playlistId = activePlaylist->id;
+    statusLabel->setText("جاري قراءة الملفات المضافة...");
+    importPool.start([this, paths, playlistId]() {
+        QStringList files = collectAudioFiles(paths, importsCanceled);
+        if (importsCanceled.loadAcquire()) return;
+        QMetaObject::invokeMethod(this, [this, playlistId, files]() {
+            importCollected(playlistId, files);
+        }, Qt::QueuedConnection);
+    });
+}
 
-    QMessageBox::information(this, "نجاح", "تمت إضافة السورة بنجاح.");
+void AudioPlayer::importCollected(PlaylistId playlistId, const QStringList& filePaths)
+{
+    QSharedPointer<Playlist> list = playlists.get(playlistId);
+    if (!list) return;
+
+    if (importFiles(list, filePaths) == 0 && !smartLists.isSmart(playlistId)) {
+        statusLabel->setText(filePaths.isEmpty() ? "لا توجد ملفات صوت فيما أُضيف" : "الملفات مضافة بالفعل إلى القائمة");
+    }
 }
 
-bool AudioPlayer::deleteSurahFromActiveList(const QString& name)
+int AudioPlayer::importFiles(const QSharedPointer<Playlist>& list, const QStringList& filePaths)
 {
-    if (!activePlaylist) return false;
+    if (!list || filePaths.isEmpty()) return 0;
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    QProgressDialog progress("جاري إضافة السور...", "إلغاء", 0, filePaths.size(), this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+
+    // 1. تحويل المسارات إلى أرقام واستبعاد المكرر (في القائمة أو داخل الدفعة نفسها)
+    //    لا يتغير شيء في القائمة قبل انتهاء هذه المرحلة، فالإلغاء لا يترك إضافة ناقصة
+    PathTable& table = PathTable::instance();
+    TrackCatalog& catalog = TrackCatalog::instance();
+    QVector<PathId> newIds;
+    newIds.reserve(filePaths.size());
+    QSet<PathId> seen;
+    seen.reserve(filePaths.size());
+
+    for (int i = 0; i < filePaths.size(); ++i) {
+        if ((i & 1023) == 0) {
+            progress.setValue(i);
+            if (progress.wasCanceled()) return 0;
+        }
 
-    SurahNode* current = activePlaylist->head;
+        PathId pathId = catalog.add(filePaths[i]);
+        PathId canonical = table.canonicalId(pathId);
+        if (list->containsPath(pathId) || seen.contains(canonical)) continue;
 
-    while (current != nullptr && current->name != name) {
-        current = current->next;
+        seen.insert(canonical);
+        newIds.append(pathId);
     }
+    progress.setValue(filePaths.size());
+
+    // الملفات دخلت المكتبة، والقائمة الذكية تأخذ منها ما يطابق شروطها فقط
+    if (smartLists.isSmart(list->id)) {
+        statusLabel->setText("تمت إضافة الملفات للمكتبة، والقائمة الذكية تعرض ما يطابق شروطها");
+        return 0;
+    }
+    if (newIds.isEmpty()) return 0;
+
+    // 2. حجز كل العقد وربطها بالقائمة وتحديث العرض دفعة واحدة
+    PlaylistEdit edit;
+    edit.type = PlaylistEdit::InsertRows;
+    edit.playlistId = list->id;
+    edit.row = list->count();
+    edit.anchor = list->tail ? list->tail->pathId : INVALID_PATH_ID;
+    edit.pathIds = newIds;
+
+    insertRows(*list, edit.row, newIds);
+    journal.record(EditStep() << edit);
+
+    double seconds = qMax(elapsed.nsecsElapsed() / 1e9, 1e-9);
+    int tracksPerSecond = int(newIds.size() / seconds);
+    qDebug() << "Imported" << newIds.size() << "of" << filePaths.size() << "files in"
+        << elapsed.elapsed() << "ms (" << tracksPerSecond << "tracks/s )";
+    statusLabel->setText(QString("تمت إضافة %1 سورة (%2 سورة/ثانية)").arg(newIds.size()).arg(tracksPerSecond));
+
+    return newIds.size();
+}
 
-    if (current == nullptr) return false;
+bool AudioPlayer::isDisplayed(const Playlist& list) const
+{
+    return playlistModel->playlist() == &list;
+}
 
-    if (current == activePlaylist->head) {
-        activePlaylist->head = current->next;
+void AudioPlayer::insertRows(Playlist& list, int row, const QVector<PathId>& pathIds)
+{
+    if (pathIds.isEmpty()) return;
+
+    list.reserveNodes(pathIds.size());
+    QVector<SurahNode*> nodes;
+    nodes.reserve(pathIds.size());
+    for (PathId pathId : pathIds) {
+        SurahNode* node = list.createNode();
+        node->pathId = pathId;
+        nodes.append(node);
+    }
+    row = qBound(0, row, list.count());
+    bool shown = isDisplayed(list);
+    if (shown) playlistModel->beginInsertTracks(row, nodes.size());
+    list.insertBatch(row, nodes);
+    if (shown) playlistModel->endInsertTracks();
+
+    if (shuffleEnabled && shuffle.playlist() == &list) {
+        for (SurahNode* node : nodes) {
+            shuffle.onInserted(node);
+        }
+    }
+    if (playOrder.playlist() == &list) {
+        for (SurahNode* node : nodes) {
+            playOrder.onInserted(node);
+        }
     }
+}
 
-    if (current == activePlaylist->tail) {
-        activePlaylist->tail = current->prev;
+QVector<PathId> AudioPlayer::removeRows(Playlist& list, int row, int count)
+{
+    QVector<PathId> pathIds;
+    if (row < 0 || row >= list.count() || count <= 0) return pathIds;
+    count = qMin(count, list.count() - row);
+
+    bool shown = isDisplayed(list);
+    if (shown) playlistModel->beginRemoveTracks(row, count);
+    QVector<SurahNode*> removed = list.removeRange(row, count);
+    if (shown) playlistModel->endRemoveTracks();
+
+    pathIds.reserve(removed.size());
+    bool currentRemoved = false;
+    bool shuffling = shuffleEnabled && shuffle.playlist() == &list;
+    bool ordered = playOrder.playlist() == &list;
+    for (SurahNode* node : removed) {
+        if (node == currentSurah) currentRemoved = true;
+        if (node == resumeSurah) resumeSurah = nullptr;
+        if (shuffling) shuffle.onRemoved(node);
+        if (ordered) playOrder.onRemoved(node);
+        pathIds.append(node->pathId);
     }
 
-    if (current->prev != nullptr) {
-        current->prev->next = current->next;
+    // العقد ستُحرر، فلا تبقى في الطابور ولا في الفتح المسبق
+    if (playQueue.removeNodes(removed) > 0) {
+        preloadNext();
     }
-    if (current->next != nullptr) {
-        current->next->prev = current->prev;
+    for (SurahNode* node : removed) {
+        list.destroyNode(node);
     }
 
-    delete current;
-    return true;
+    // إيقاف التشغيل فقط إذا كانت السورة الحالية ضمن المحذوف
+    if (currentRemoved) {
+        stopClicked();
+        currentSurah = nullptr;
+        playingPlaylist.reset();
+        shuffle.clear();
+        playOrder.clear();
+    }
+
+    return pathIds;
 }
 
-void AudioPlayer::deleteSurahClicked()
+void AudioPlayer::reorderRows(Playlist& list, const QVector<int>& oldRows)
 {
-    QListWidgetItem* item = playlistWidget->currentItem();
-    if (!item) {
-        QMessageBox::warning(this, "تنبيه", "يجب تحديد سورة من القائمة للحذف.");
+    bool shown = isDisplayed(list);
+    if (shown) playlistModel->beginReorder();
+    list.permute(oldRows);
+    if (!shown) return;
+    playlistModel->endReorder();
+
+    int playingRow = list.indexOf(currentSurah);
+    if (playingRow >= 0) setCurrentRow(playingRow);
+}
+
+void AudioPlayer::moveTracks(Playlist& list, int row, int count, int newRow)
+{
+    if (count <= 0 || newRow == row) return;
+
+    bool shown = isDisplayed(list);
+    bool moving = shown && playlistModel->beginMoveTracks(row, count, newRow);
+    if (shown && !moving) playlistModel->beginReorder();
+
+    list.moveRange(row, count, newRow);
+
+    if (moving) playlistModel->endMoveTracks();
+    else if (shown) playlistModel->endReorder();
+}
+
+void AudioPlayer::moveActiveRows(EditStep& step, int row, int count, int newRow)
+{
+    if (row == newRow) return;
+
+    PlaylistEdit edit;
+    edit.type = PlaylistEdit::MoveRows;
+    edit.playlistId = activePlaylist->id;
+    edit.row = row;
+    edit.count = count;
+    edit.newRow = newRow;
+    edit.pathIds.reserve(count);
+    for (SurahNode* node = activePlaylist->at(row); node != nullptr && edit.pathIds.size() < count; node = node->next) {
+        edit.pathIds.append(node->pathId);
+    }
+
+    moveTracks(*activePlaylist, row, count, newRow);
+    step.append(edit);
+}
+
+void AudioPlayer::moveRowsTo(const QList<int>& rows, int targetRow)
+{
+    if (!activePlaylist || rows.isEmpty()) return;
+
+    QVector<QPair<int, int>> ranges = groupRanges(rows);
+
+    targetRow = qBound(0, targetRow, activePlaylist->count());
+    // الإفلات داخل مجال محدد = الإفلات عند بدايته
+    for (const QPair<int, int>& range : ranges) {
+        if (range.first < targetRow && targetRow < range.first + range.second) targetRow = range.first;
+    }
+
+    EditStep step;
+
+    // المجالات فوق الهدف: الأقرب أولاً، كل مجال يستقر فوق الذي قبله مباشرة
+    int insertAt = targetRow;
+    for (int i = ranges.size() - 1; i >= 0; --i) {
+        if (ranges[i].first >= targetRow) continue;
+        int newRow = insertAt - ranges[i].second;
+        moveActiveRows(step, ranges[i].first, ranges[i].second, newRow);
+        insertAt = newRow;
+    }
+    int firstRow = insertAt;
+
+    // المجالات تحت الهدف: بالترتيب، كل مجال يستقر تحت الذي قبله
+    insertAt = targetRow;
+    for (const QPair<int, int>& range : ranges) {
+        if (range.first < targetRow) continue;
+        moveActiveRows(step, range.first, range.second, insertAt);
+        insertAt += range.second;
+    }
+
+    if (step.isEmpty()) return;
+    journal.record(step);
+
+    // إبقاء السور المنقولة محددة
+    QItemSelection selection(playlistModel->index(firstRow), playlistModel->index(insertAt - 1));
+    playlistView->selectionModel()->select(selection, QItemSelectionModel::ClearAndSelect);
+    playlistView->selectionModel()->setCurrentIndex(playlistModel->index(firstRow), QItemSelectionModel::NoUpdate);
+    playlistView->scrollTo(playlistModel->index(firstRow));
+}
+
+void AudioPlayer::tracksDropped(const QList<int>& rows, int targetRow)
+{
+    if (!canMoveRows()) return;
+    moveRowsTo(rows, targetRow);
+}
+
+bool AudioPlayer::canMoveRows()
+{
+    if (isSmartActive()) {
+        statusLabel->setText("ترتيب القائمة الذكية يتغير بالفرز فقط");
+        return false;
+    }
+    if (!playlistModel->isFiltered()) return true;
+    statusLabel->setText("امسح البحث أولاً لنقل السور");
+    return false;
+}
+
+bool AudioPlayer::isSmartActive() const
+{
+    return activePlaylist && smartLists.isSmart(activePlaylist->id);
+}
+
+void AudioPlayer::moveSelectedUpClicked()
+{
+    if (!canMoveRows()) return;
+
+    QList<int> rows = selectedRows();
+    if (rows.isEmpty() || rows.first() == 0) return;
+    moveSelectionBy(rows, -1);
+}
+
+void AudioPlayer::moveSelectedDownClicked()
+{
+    if (!canMoveRows()) return;
+
+    QList<int> rows = selectedRows();
+    if (rows.isEmpty() || !activePlaylist || rows.last() >= activePlaylist->count() - 1) return;
+    moveSelectionBy(rows, 1);
+}
+
+void AudioPlayer::moveSelectionBy(const QList<int>& rows, int offset)
+{
+    // كل مجال محدد يتحرك صفاً واحداً (بدون ضم المجالات المتفرقة معاً)
+    QVector<QPair<int, int>> ranges = groupRanges(rows);
+
+    EditStep step;
+    QItemSelection selection;
+    for (int i = 0; i < ranges.size(); ++i) {
+        const QPair<int, int>& range = offset < 0 ? ranges[i] : ranges[ranges.size() - 1 - i];
+        int newRow = range.first + offset;
+        moveActiveRows(step, range.first, range.second, newRow);
+        selection.select(playlistModel->index(newRow), playlistModel->index(newRow + range.second - 1));
+    }
+    journal.record(step);
+
+    int currentRow = playlistView->currentIndex().isValid() ? playlistView->currentIndex().row() + offset : ranges.first().first + offset;
+    playlistView->selectionModel()->select(selection, QItemSelectionModel::ClearAndSelect);
+    playlistView->selectionModel()->setCurrentIndex(playlistModel->index(currentRow), QItemSelectionModel::NoUpdate);
+    playlistView->scrollTo(playlistModel->index(currentRow));
+}
+
+void AudioPlayer::setCurrentRow(int row)
+{
+    QModelIndex index = playlistModel->index(playlistModel->viewRow(row));
+    if (!index.isValid()) return;
+
+    playlistView->setCurrentIndex(index);
+    playlistView->scrollTo(index);
+}
+
+void AudioPlayer::searchTextChanged(const QString& text)
+{
+    playlistModel->setFilterText(text);
+
+    if (playlistModel->isFiltered()) {
+        statusLabel->setText(QString("نتائج البحث: %1 سورة").arg(playlistModel->rowCount()));
+    }
+    else if (activePlaylist) {
+        statusLabel->setText("تم تحميل قائمة: " + activePlaylist->name);
+    }
+
+    int playingRow = activePlaylist ? activePlaylist->indexOf(currentSurah) : -1;
+    if (playingRow >= 0) setCurrentRow(playingRow);
+}
+
+void AudioPlayer::sortRequested(int index)
+{
+    if (!activePlaylist || index < 0) return;
+
+    PlaylistSorter::Key key = PlaylistSorter::Key(sortSelector->itemData(index).toInt());
+    Qt::SortOrder order = sortDescendingBtn->isChecked() ? Qt::DescendingOrder : Qt::AscendingOrder;
+
+    QVector<int> oldRows = PlaylistSorter::sortedOrder(*activePlaylist, key, order);
+    if (PlaylistSorter::isIdentity(oldRows)) {
+        statusLabel->setText("القائمة مرتبة بالفعل");
         return;
     }
 
-    int indexToDelete = playlistWidget->row(item);
+    PlaylistEdit edit;
+    edit.type = PlaylistEdit::ReorderRows;
+    edit.playlistId = activePlaylist->id;
+    edit.rowOrder = oldRows;
+    edit.pathIds.reserve(oldRows.size());
+    for (SurahNode* node = activePlaylist->head; node != nullptr; node = node->next) {
+        edit.pathIds.append(node->pathId);
+    }
+
+    reorderRows(*activePlaylist, oldRows);
+    journal.record(EditStep() << edit);
+
+    statusLabel->setText("تم ترتيب القائمة حسب " + sortSelector->itemText(index));
+}
+
+void AudioPlayer::sortOrderToggled(bool descending)
+{
+    sortDescendingBtn->setToolTip(descending ? "ترتيب تصاعدي" : "ترتيب تنازلي");
+    sortRequested(sortSelector->currentIndex());
+}
 
-    SurahNode* nodeToDelete = activePlaylist->head;
-    for (int i = 0; i < indexToDelete; ++i) {
-        if (nodeToDelete) {
-            nodeToDelete = nodeToDelete->next;
+void AudioPlayer::trackAdded(TrackId trackId)
+{
+    smartLists.trackAdded(trackId);
+    scheduleSmartChanges();
+
+    pendingMetadata.append(trackId);
+    if (!metadataScheduled) {
+        metadataScheduled = true;
+        QTimer::singleShot(0, this, &AudioPlayer::readPendingMetadata);
+    }
+}
+
+void AudioPlayer::readPendingMetadata()
+{
+    metadataScheduled = false;
+
+    // الوسوم والمدد المعروفة من الفهرس المحفوظ (أو الموروثة عند إعادة التسمية) تصل بعد
+    // trackAdded في نفس الحدث، فالتصفية هنا وليس عند الإضافة
+    const TrackCatalog& catalog = TrackCatalog::instance();
+    QVector<PathId> tagIds;
+    QVector<PathId> durationIds;
+    for (TrackId trackId : pendingMetadata) {
+        const TrackInfo& info = catalog.info(trackId);
+        if (!info.tagsRead) tagIds.append(trackId);
+        if (info.durationMs < 0) durationIds.append(trackId);
+    }
+    pendingMetadata.clear();
+    if (!tagIds.isEmpty()) metadataReader->readTags(tagIds);
+    if (!durationIds.isEmpty()) metadataReader->readDurations(durationIds);
+}
+
+void AudioPlayer::metadataRead(const QVector<MetadataReader::Result>& results)
+{
+    // كل سورة تغير عنوانها تُحدّث صفوفها في العرض عبر trackChanged
+    TrackCatalog& catalog = TrackCatalog::instance();
+    for (const MetadataReader::Result& result : results) {
+        const AudioTags& tags = result.tags;
+        catalog.setTags(result.pathId, tags.title, tags.reciter, tags.album, tags.surahNumber);
+        if (result.fileSize >= 0) catalog.setFileSize(result.pathId, result.fileSize);
+    }
+}
+
+void AudioPlayer::durationsRead(const QVector<MetadataReader::Result>& results)
+{
+    TrackCatalog& catalog = TrackCatalog::instance();
+    for (const MetadataReader::Result& result : results) {
+        if (result.durationMs < 0) continue;
+        catalog.setDuration(result.pathId, result.durationMs);
+
+        // السورة التي بدأت قبل أن تُعرف مدتها
+        if (isLoaded && totalFrames == 0 && catalog.trackOf(currentSurah->pathId) == catalog.trackOf(result.pathId)) {
+            setTotalFrames(ma_uint64(result.durationMs) * audioDecoder->outputSampleRate / 1000);
         }
-        else {
-            QMessageBox::critical(this, "خطأ", "فشل في مزامنة البيانات.");
-            return;
+    }
+}
+
+void AudioPlayer::trackChanged(TrackId trackId, int fields)
+{
+    smartLists.trackChanged(trackId, fields);
+    scheduleSmartChanges();
+
+    // فقط ما يظهر في الواجهة (الاسم والمدة) يحتاج تحديثاً، والترتيب يقرأ من الفهرس مباشرة
+    if (!(fields & (TrackCatalog::TagsField | TrackCatalog::DurationField)) || !activePlaylist) return;
+
+    // العنوان الجديد قد يطابق البحث الحالي أو لا يطابقه بعد الآن
+    if (fields & TrackCatalog::TagsField) playlistModel->refilterTrack(trackId);
+
+    for (auto it = activePlaylist->pathIndex.constFind(trackId);
+        it != activePlaylist->pathIndex.constEnd() && it.key() == trackId; ++it) {
+        playlistModel->refreshRow(activePlaylist->indexOf(it.value()));
+    }
+}
+
+void AudioPlayer::expireSmartPlaylists()
+{
+    smartLists.expire(QDateTime::currentSecsSinceEpoch());
+    scheduleSmartChanges();
+}
+
+void AudioPlayer::scheduleSmartChanges()
+{
+    if (smartChangesScheduled) return;
+    if (!smartLists.hasChanges() && heldSmartChanges.isEmpty()) return;
+
+    smartChangesScheduled = true;
+    QTimer::singleShot(0, this, &AudioPlayer::applySmartChanges);
+}
+
+void AudioPlayer::applySmartChanges()
+{
+    smartChangesScheduled = false;
+
+    QVector<SmartPlaylistEngine::Change> changes;
+    changes.swap(heldSmartChanges);
+    changes += smartLists.takeChanges();
+
+    // السورة قد تنضم وتخرج قبل التطبيق، فالمرجع هو العضوية الحالية في المحرك
+    QHash<PlaylistId, QVector<PathId>> joined;
+    QSet<quint64> joinedKeys;
+
+    for (const SmartPlaylistEngine::Change& change : changes) {
+        QSharedPointer<Playlist> list = playlists.get(change.playlistId);
+        if (!list) continue;
+
+        bool member = smartLists.contains(change.playlistId, change.trackId);
+        SurahNode* node = list->findPath(change.trackId);
+
+        if (member && node == nullptr) {
+            quint64 key = (quint64(quint32(change.playlistId)) << 32) | change.trackId;
+            if (joinedKeys.contains(key)) continue;
+            joinedKeys.insert(key);
+            joined[change.playlistId].append(change.trackId);
+        }
+        else if (!member && node != nullptr) {
+            // معرفة مدة السورة عند تشغيلها قد تخرجها من القائمة، فلا نقطع تشغيلها
+            if (node == currentSurah) {
+                heldSmartChanges.append(change);
+                continue;
+            }
+            removeRows(*list, list->indexOf(node), 1);
+        }
+    }
+
+    // السور المنضمة تُضاف لآخر كل قائمة دفعة واحدة
+    for (auto it = joined.constBegin(); it != joined.constEnd(); ++it) {
+        QSharedPointer<Playlist> list = playlists.get(it.key());
+        insertRows(*list, list->count(), it.value());
+    }
+}
+
+bool AudioPlayer::applyEdit(const PlaylistEdit& edit, bool reverse)
+{
+    if (edit.type == PlaylistEdit::RenamePlaylist) {
+        renamePlaylist(edit.playlistId, reverse ? edit.oldName : edit.newName);
+        return true;
+    }
+
+    QSharedPointer<Playlist> list = playlists.get(edit.playlistId);
+    if (list == nullptr) return false;
+
+    // الصفوف المسجلة قد تكون انزاحت بتغييرات الفحص، فالترجمة للصفوف الحالية في EditJournal
+    EditStep operations = EditJournal::resolve(*list, edit, reverse);
+    for (const PlaylistEdit& operation : operations) {
+        switch (operation.type) {
+        case PlaylistEdit::InsertRows:
+            insertRows(*list, operation.row, operation.pathIds);
+            break;
+        case PlaylistEdit::RemoveRows:
+            removeRows(*list, operation.row, operation.count);
+            break;
+        case PlaylistEdit::MoveRows:
+            moveTracks(*list, operation.row, operation.count, operation.newRow);
+            break;
+        case PlaylistEdit::ReorderRows:
+            if (!PlaylistSorter::isIdentity(operation.rowOrder)) reorderRows(*list, operation.rowOrder);
+            break;
+        default:
+            break;
         }
     }
+    return !operations.isEmpty();
+}
 
-    if (nodeToDelete == nullptr) {
-        QMessageBox::critical(this, "خطأ", "العقدة غير موجودة في الذاكرة.");
+void AudioPlayer::undoClicked()
+{
+    if (!journal.canUndo()) return;
+
+    EditStep step = journal.takeUndo();
+    bool applied = false;
+    for (int i = step.size() - 1; i >= 0; --i) {
+        applied |= applyEdit(step[i], true);
+    }
+    if (!applied) {
+        journal.dropUndone();
+        statusLabel->setText("تعذر التراجع: السور المعدلة لم تعد في القائمة");
         return;
     }
+    statusLabel->setText("تم التراجع عن آخر تعديل");
+}
 
-    QString surahNameInList = nodeToDelete->name;
+void AudioPlayer::redoClicked()
+{
+    if (!journal.canRedo()) return;
 
-    if (currentSurah && currentSurah->name == surahNameInList) {
-        stopClicked();
-        currentSurah = nullptr;
+    EditStep step = journal.takeRedo();
+    bool applied = false;
+    for (const PlaylistEdit& edit : step) {
+        applied |= applyEdit(edit, false);
     }
+    if (!applied) {
+        journal.dropRedone();
+        statusLabel->setText("تعذرت الإعادة: السور المعدلة لم تعد في القائمة");
+        return;
+    }
+    statusLabel->setText("تمت إعادة التعديل");
+}
 
-    if (deleteSurahFromActiveList(surahNameInList)) {
-        delete playlistWidget->takeItem(playlistWidget->row(item));
-        QMessageBox::information(this, "نجاح", "تم حذف السورة بنجاح.");
+void AudioPlayer::setUndoLimit(int limit)
+{
+    journal.setLimit(limit);
+}
 
-        for (int i = 0; i < playlistWidget->count(); ++i) {
-            QListWidgetItem* currentItem = playlistWidget->item(i);
-            QString oldText = currentItem->text();
-            QString baseName = oldText.section('.', 1).trimmed();
-            currentItem->setText(QString::number(i + 1) + ". " + baseName);
-        }
+void AudioPlayer::dragEnterEvent(QDragEnterEvent* event)
+{
+    if (event->mimeData()->hasUrls()) {
+        event->acceptProposedAction();
     }
-    else {
-        QMessageBox::critical(this, "خطأ", "فشل الحذف من القائمة المترابطة (خطأ منطقي).");
+}
+
+void AudioPlayer::dropEvent(QDropEvent* event)
+{
+    QStringList paths;
+    for (const QUrl& url : event->mimeData()->urls()) {
+        if (url.isLocalFile()) paths.append(url.toLocalFile());
+    }
+
+    if (!paths.isEmpty()) {
+        importPaths(paths);
+        event->acceptProposedAction();
+    }
+}
+
+void AudioPlayer::deleteSurahClicked()
+{
+    if (!activePlaylist) return;
+    if (isSmartActive()) {
+        QMessageBox::information(this, "قائمة ذكية", "لا يمكن حذف سور من قائمة ذكية، فهي تتحدث تلقائياً حسب شروطها.");
+        return;
     }
+
+    QList<int> rows = selectedRows();
+    if (rows.isEmpty()) {
+        QMessageBox::warning(this, "تنبيه", "يجب تحديد سورة من القائمة للحذف.");
+        return;
+    }
+
+    // نحذف الصفوف على شكل مجالات متتالية من الأسفل للأعلى حتى لا تتغير أرقام المجالات المتبقية،
+    // وكل مجال يرسل حذف صفوفه للعرض (أثناء البحث يُحدّث العرض مرة واحدة بعد كل المجالات)
+    QVector<QPair<int, int>> ranges = groupRanges(rows);
+
+    EditStep step;
+    int removedCount = 0;
+
+    bool batched = ranges.size() > 1;
+    if (batched) playlistModel->beginBatch();
+    for (int i = ranges.size() - 1; i >= 0; --i) {
+        PlaylistEdit edit;
+        edit.type = PlaylistEdit::RemoveRows;
+        edit.playlistId = activePlaylist->id;
+        edit.row = ranges[i].first;
+        SurahNode* before = activePlaylist->at(edit.row - 1);
+        edit.anchor = before ? before->pathId : INVALID_PATH_ID;
+        edit.pathIds = removeRows(*activePlaylist, edit.row, ranges[i].second);
+
+        removedCount += edit.pathIds.size();
+        step.append(edit);
+    }
+    if (batched) playlistModel->endBatch();
+    journal.record(step);
+
+    statusLabel->setText(QString("تم حذف %1 سورة").arg(removedCount));
 }
 
 bool AudioPlayer::loadTrack(SurahNode* node) {
@@ -602,55 +1936,84 @@ bool AudioPlayer::loadTrack(SurahNode* node) {
         return false;
     }
 
-    qDebug() << "Loading track:" << node->name;
+    qDebug() << "Loading track:" << node->name();
     stopClicked();
 
     currentSurah = node;
-    std::wstring wFilePath = currentSurah->path.toStdWString();
+    // سورة أُجل خروجها من قائمة ذكية لأنها كانت تُشغل
+    if (!heldSmartChanges.isEmpty()) scheduleSmartChanges();
+    // أثناء تشغيل الطابور تبقى القائمة التي سنعود إليها كما هي
+    if (resumeSurah == nullptr && activePlaylist && activePlaylist->indexOf(node) >= 0) {
+        playingPlaylist = activePlaylist;
+    }
 
-    if (::ma_decoder_init_file_w(wFilePath.c_str(), NULL, &audioDecoder) != MA_SUCCESS) {
-        QMessageBox::critical(this, "خطأ في الملف", "لم يتم العثور على الملف:\n" + currentSurah->path);
-        return false;
+    // الملف مفتوح مسبقاً إن كانت هذه السورة أول الطابور
+    audioDecoder = preloader.take(node);
+    if (audioDecoder != nullptr) {
+        qDebug() << "Using preloaded decoder";
+    }
+    else {
+        std::wstring wFilePath = currentSurah->path().toStdWString();
+        audioDecoder = new ma_decoder;
+        if (::ma_decoder_init_file_w(wFilePath.c_str(), NULL, audioDecoder) != MA_SUCCESS) {
+            delete audioDecoder;
+            audioDecoder = nullptr;
+            QMessageBox::critical(this, "خطأ في الملف", "لم يتم العثور على الملف:\n" + currentSurah->path());
+            return false;
+        }
     }
 
-    ::ma_decoder_get_length_in_pcm_frames(&audioDecoder, &totalFrames);
+    // طول MP3 بمعدل بت متغير يتطلب المرور على الملف كله، فلا يُحسب هنا:
+    // المدة من الفهرس، أو تُحسب في الخلفية وتصل لـ durationsRead أثناء التشغيل.
+    // تقريبها لأقل ملي ثانية ينقص بضع عشرات من الإطارات، وهي داخل هامش كشف النهاية
+    TrackCatalog& catalog = TrackCatalog::instance();
+    qint32 durationMs = catalog.info(currentSurah->pathId).durationMs;
+    lastCursor = 0;
+    progressCursor = 0;
+    listenedFrames = 0;
+    playCounted = false;
+    stuckCounter = 0;
+    if (durationMs > 0) {
+        setTotalFrames(ma_uint64(durationMs) * audioDecoder->outputSampleRate / 1000);
+    }
+    else {
+        setTotalFrames(0);
+        metadataReader->readDurationNow(currentSurah->pathId);
+    }
     qDebug() << "Total frames for this track:" << totalFrames;
 
-    totalTimeLabel->setText(formatTime(totalFrames, audioDecoder.outputSampleRate));
-    seekSlider->setRange(0, (int)totalFrames);
-
     deviceConfig = ::ma_device_config_init(ma_device_type_playback);
-    deviceConfig.playback.format = audioDecoder.outputFormat;
-    deviceConfig.playback.channels = audioDecoder.outputChannels;
-    deviceConfig.sampleRate = audioDecoder.outputSampleRate;
+    deviceConfig.playback.format = audioDecoder->outputFormat;
+    deviceConfig.playback.channels = audioDecoder->outputChannels;
+    deviceConfig.sampleRate = audioDecoder->outputSampleRate;
     deviceConfig.dataCallback = data_callback;
-    deviceConfig.pUserData = &audioDecoder;
+    deviceConfig.pUserData = audioDecoder;
 
     if (::ma_device_init(NULL, &deviceConfig, &audioDevice) != MA_SUCCESS) {
-        ::ma_decoder_uninit(&audioDecoder);
+        ::ma_decoder_uninit(audioDecoder);
+        delete audioDecoder;
+        audioDecoder = nullptr;
         return false;
     }
 
     setVolume(volumeSlider->value());
     isLoaded = true;
 
-    for (int i = 0; i < playlistWidget->count(); ++i) {
-        QListWidgetItem* item = playlistWidget->item(i);
-        QString baseName = item->text().section('.', 1).trimmed();
-        if (baseName == currentSurah->name) {
-            playlistWidget->setCurrentItem(item);
-            break;
-        }
+    int row = activePlaylist ? activePlaylist->indexOf(currentSurah) : -1;
+    if (row >= 0) {
+        setCurrentRow(row);
     }
 
     qDebug() << "Track loaded successfully. Has next?" << (currentSurah->next != nullptr);
 
+    preloadNext();
     return true;
 }
 
 void AudioPlayer::playPauseClicked() {
     if (!isLoaded) {
         if (!activePlaylist || activePlaylist->head == nullptr) return;
+        playOrder.clear();
         loadTrack(activePlaylist->head);
     }
 
@@ -658,13 +2021,13 @@ void AudioPlayer::playPauseClicked() {
         ::ma_device_stop(&audioDevice);
         timer->stop();
         isPlaying = false;
-        statusLabel->setText("متوقف: " + currentSurah->name);
+        statusLabel->setText("متوقف: " + currentSurah->name());
     }
     else {
         ::ma_device_start(&audioDevice);
         timer->start(100);
         isPlaying = true;
-        statusLabel->setText("تشغيل: " + currentSurah->name);
+        statusLabel->setText("تشغيل: " + currentSurah->name());
     }
     updateUiState();
 }
@@ -674,7 +2037,9 @@ void AudioPlayer::stopClicked() {
         timer->stop();
         ::ma_device_stop(&audioDevice);
         ::ma_device_uninit(&audioDevice);
-        ::ma_decoder_uninit(&audioDecoder);
+        ::ma_decoder_uninit(audioDecoder);
+        delete audioDecoder;
+        audioDecoder = nullptr;
         isLoaded = false;
         isPlaying = false;
         seekSlider->setValue(0);
@@ -691,6 +2056,7 @@ void AudioPlayer::restartClicked() {
         }
     }
     else if (activePlaylist && activePlaylist->head) {
+        playOrder.clear();
         if (loadTrack(activePlaylist->head)) {
             playPauseClicked();
         }
@@ -703,7 +2069,7 @@ void AudioPlayer::updateProgress() {
     }
 
     ma_uint64 cursor;
-    ma_result result = ::ma_decoder_get_cursor_in_pcm_frames(&audioDecoder, &cursor);
+    ma_result result = ::ma_decoder_get_cursor_in_pcm_frames(audioDecoder, &cursor);
 
     if (result != MA_SUCCESS) {
         return;
@@ -713,7 +2079,7 @@ void AudioPlayer::updateProgress() {
     seekSlider->blockSignals(true);
     seekSlider->setValue((int)cursor);
     seekSlider->blockSignals(false);
-    currentTimeLabel->setText(formatTime(cursor, audioDecoder.outputSampleRate));
+    currentTimeLabel->setText(formatTime(cursor, audioDecoder->outputSampleRate));
 
     // Debug output every second (10 timer ticks at 100ms)
     static int debugCounter = 0;
@@ -722,16 +2088,36 @@ void AudioPlayer::updateProgress() {
         debugCounter = 0;
     }
 
+    // تقدم أكثر من ثانية بين نبضتين = قفز بالتقديم، لا يُحسب استماعاً
+    ma_uint32 sampleRate = audioDecoder->outputSampleRate;
+    if (cursor > progressCursor && cursor - progressCursor <= sampleRate) listenedFrames += cursor - progressCursor;
+    progressCursor = cursor;
+    if (!playCounted && sampleRate > 0 && listenedFrames >= ma_uint64(PLAY_COUNT_MIN_MS) * sampleRate / 1000) {
+        countPlay();
+    }
+
+    // المدة لم تصل بعد: النهاية هي توقف المؤشر عن التقدم ثانية كاملة
+    bool ended = false;
+    if (totalFrames == 0) {
+        stuckCounter = cursor == lastCursor ? stuckCounter + 1 : 0;
+        lastCursor = cursor;
+        ended = stuckCounter >= 10;
+    }
+
     // Check if track finished - use a threshold to catch the end
-    if (totalFrames > 0 && cursor >= (totalFrames - 500)) {
+    if (ended || (totalFrames > 0 && cursor >= (totalFrames - 500))) {
+        countPlay();
+
         qDebug() << "========================";
         qDebug() << "TRACK ENDING DETECTED!";
         qDebug() << "cursor:" << cursor << "totalFrames:" << totalFrames;
-        qDebug() << "currentSurah:" << (currentSurah ? currentSurah->name : "NULL");
-        qDebug() << "Has next:" << (currentSurah && currentSurah->next ? "YES" : "NO");
+        qDebug() << "currentSurah:" << (currentSurah ? currentSurah->name() : "NULL");
 
-        if (currentSurah && currentSurah->next) {
-            qDebug() << "Next track:" << currentSurah->next->name;
+        SurahNode* nextNode = nextTrack();
+        qDebug() << "Has next:" << (nextNode ? "YES" : "NO");
+
+        if (nextNode) {
+            qDebug() << "Next track:" << nextNode->name();
         }
         qDebug() << "========================";
 
@@ -739,9 +2125,8 @@ void AudioPlayer::updateProgress() {
         timer->stop();
 
         // Move to next track
-        if (currentSurah != nullptr && currentSurah->next != nullptr) {
-            SurahNode* nextNode = currentSurah->next;
-            qDebug() << "Attempting to load next track:" << nextNode->name;
+        if (nextNode != nullptr) {
+            qDebug() << "Attempting to load next track:" << nextNode->name();
 
             if (loadTrack(nextNode)) {
                 qDebug() << "Next track loaded, starting playback...";
@@ -761,8 +2146,9 @@ void AudioPlayer::updateProgress() {
 
 void AudioPlayer::seekTo(int value) {
     if (isLoaded) {
-        ::ma_decoder_seek_to_pcm_frame(&audioDecoder, (ma_uint64)value);
-        currentTimeLabel->setText(formatTime(value, audioDecoder.outputSampleRate));
+        ::ma_decoder_seek_to_pcm_frame(audioDecoder, (ma_uint64)value);
+        progressCursor = (ma_uint64)value;
+        currentTimeLabel->setText(formatTime(value, audioDecoder->outputSampleRate));
     }
 }
 
@@ -773,6 +2159,20 @@ void AudioPlayer::setVolume(int value) {
     }
 }
 
+void AudioPlayer::countPlay()
+{
+    if (playCounted || currentSurah == nullptr) return;
+    playCounted = true;
+    TrackCatalog::instance().recordPlay(currentSurah->pathId);
+}
+
+void AudioPlayer::setTotalFrames(ma_uint64 frames)
+{
+    totalFrames = frames;
+    totalTimeLabel->setText(frames > 0 ? formatTime(frames, audioDecoder->outputSampleRate) : "--:--");
+    seekSlider->setRange(0, (int)frames);
+}
+
 QString AudioPlayer::formatTime(ma_uint64 frames, ma_uint32 sampleRate) {
     if (sampleRate == 0) return "00:00";
     qint64 totalSeconds = frames / sampleRate;
@@ -782,9 +2182,91 @@ QString AudioPlayer::formatTime(ma_uint64 frames, ma_uint32 sampleRate) {
     return time.toString("mm:ss");
 }
 
+SurahNode* AudioPlayer::nextTrack()
+{
+    // الطابور له الأولوية على ترتيب القائمة
+    if (!playQueue.isEmpty()) {
+        QueuedTrack queued = playQueue.dequeue();
+        if (resumeSurah == nullptr) {
+            resumeSurah = currentSurah;
+            if (!playingPlaylist) playingPlaylist = queued.playlist;
+        }
+        return queued.node;
+    }
+
+    // انتهى الطابور: نكمل القائمة من حيث توقفنا
+    if (resumeSurah != nullptr) {
+        SurahNode* from = resumeSurah;
+        resumeSurah = nullptr;
+        if (shuffleEnabled) {
+            syncShuffle();
+            return shuffle.next();
+        }
+        return syncPlayOrder(from) ? playOrder.next() : from->next;
+    }
+
+    if (currentSurah == nullptr) return nullptr;
+
+    if (shuffleEnabled) {
+        syncShuffle();
+        return shuffle.next();
+    }
+    return syncPlayOrder(currentSurah) ? playOrder.next() : currentSurah->next;
+}
+
+SurahNode* AudioPlayer::previousTrack()
+{
+    // السابق أثناء الطابور يعود للسورة التي توقفت عندها القائمة
+    if (resumeSurah != nullptr) {
+        SurahNode* node = resumeSurah;
+        resumeSurah = nullptr;
+        return node;
+    }
+
+    if (currentSurah == nullptr) return nullptr;
+
+    if (shuffleEnabled) {
+        syncShuffle();
+        return shuffle.previous();
+    }
+    return syncPlayOrder(currentSurah) ? playOrder.previous() : currentSurah->prev;
+}
+
+bool AudioPlayer::syncPlayOrder(SurahNode* from)
+{
+    // نسخة الترتيب تؤخذ عند أول تنقل بعد بدء التشغيل من القائمة، وتبقى حتى يبدأ تشغيل جديد
+    if (!playingPlaylist) return false;
+    if (playOrder.playlist() == playingPlaylist.data() && playOrder.jumpTo(from)) return true;
+
+    playOrder.reset(playingPlaylist.data(), from);
+    return playOrder.jumpTo(from);
+}
+
+void AudioPlayer::syncShuffle()
+{
+    // ترتيب عشوائي جديد فقط عندما يتغير playingPlaylist
+    if (shuffle.playlist() != playingPlaylist.data()) {
+        shuffle.reset(playingPlaylist.data(), currentSurah);
+    }
+}
+
+void AudioPlayer::shuffleToggled(bool checked)
+{
+    shuffleEnabled = checked;
+    if (shuffleEnabled) {
+        shuffle.reset(playingPlaylist.data(), currentSurah);
+        statusLabel->setText("التشغيل العشوائي: مفعل");
+    }
+    else {
+        shuffle.clear();
+        statusLabel->setText("التشغيل العشوائي: متوقف");
+    }
+}
+
 void AudioPlayer::nextClicked() {
-    if (currentSurah != nullptr && currentSurah->next != nullptr) {
-        if (loadTrack(currentSurah->next)) {
+    SurahNode* nextNode = nextTrack();
+    if (nextNode != nullptr) {
+        if (loadTrack(nextNode)) {
             playPauseClicked();
         }
     }
@@ -795,22 +2277,97 @@ void AudioPlayer::nextClicked() {
 }
 
 void AudioPlayer::prevClicked() {
-    if (currentSurah != nullptr && currentSurah->prev != nullptr) {
-        if (loadTrack(currentSurah->prev)) {
+    SurahNode* prevNode = previousTrack();
+    if (currentSurah != nullptr && prevNode != nullptr) {
+        if (loadTrack(prevNode)) {
             playPauseClicked();
         }
     }
 }
 
-void AudioPlayer::onPlaylistDoubleClicked(QListWidgetItem* item) {
-    int index = playlistWidget->row(item);
-    SurahNode* target = activePlaylist->head;
-    for (int i = 0; i < index; i++) {
-        if (target && target->next) target = target->next;
-        else return;
+QList<int> AudioPlayer::selectedRows() const
+{
+    QList<int> rows;
+    // أرقام الصفوف في القائمة نفسها (تختلف عن أرقام العرض أثناء البحث)
+    for (const QModelIndex& index : playlistView->selectionModel()->selectedRows()) {
+        rows.append(playlistModel->listRow(index.row()));
+    }
+    if (rows.isEmpty() && playlistView->currentIndex().isValid()) {
+        rows.append(playlistModel->listRow(playlistView->currentIndex().row()));
+    }
+    rows.removeAll(-1);
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    return rows;
+}
+
+void AudioPlayer::queueSelected(bool playNext)
+{
+    if (!activePlaylist) return;
+
+    QList<int> rows = selectedRows();
+    if (rows.isEmpty()) return;
+
+    if (playNext) {
+        // الإضافة من الأمام بترتيب عكسي حتى تُشغل السور بترتيب القائمة
+        for (int i = rows.size() - 1; i >= 0; --i) {
+            playQueue.pushFront(activePlaylist, activePlaylist->at(rows[i]));
+        }
+        statusLabel->setText(QString("ستُشغل %1 سورة تالياً").arg(rows.size()));
+    }
+    else {
+        for (int row : rows) {
+            playQueue.enqueue(activePlaylist, activePlaylist->at(row));
+        }
+        statusLabel->setText(QString("أضيفت %1 سورة للطابور (%2 في الانتظار)").arg(rows.size()).arg(playQueue.count()));
     }
 
+    preloadNext();
+}
+
+void AudioPlayer::enqueueSelectedClicked()
+{
+    queueSelected(false);
+}
+
+void AudioPlayer::playNextSelectedClicked()
+{
+    queueSelected(true);
+}
+
+void AudioPlayer::preloadNext()
+{
+    // نفتح مسبقاً أول الطابور فقط حتى لا نحجز ملفات كثيرة مفتوحة
+    preloader.prepare(playQueue.isEmpty() ? nullptr : playQueue.first().node);
+}
+
+void AudioPlayer::showPlaylistContextMenu(const QPoint& pos)
+{
+    if (!playlistView->indexAt(pos).isValid()) return;
+
+    QMenu menu(this);
+    menu.addAction("تشغيل تالياً", this, &AudioPlayer::playNextSelectedClicked);
+    menu.addAction("إضافة للطابور", this, &AudioPlayer::enqueueSelectedClicked);
+    menu.addSeparator();
+    menu.addAction(moveUpAction);
+    menu.addAction(moveDownAction);
+    menu.exec(playlistView->viewport()->mapToGlobal(pos));
+}
+
+void AudioPlayer::onPlaylistDoubleClicked(const QModelIndex& index) {
+    if (!activePlaylist) return;
+
+    SurahNode* target = playlistModel->nodeAt(index.row());
+    if (target == nullptr) return;
+
+    // اختيار سورة بنفسه يلغي العودة لموضع القائمة السابق، ويبدأ ترتيباً جديداً من القائمة كما هي الآن
+    resumeSurah = nullptr;
+    playOrder.clear();
     if (loadTrack(target)) {
+        if (shuffleEnabled) {
+            if (shuffle.playlist() == playingPlaylist.data()) shuffle.jumpTo(target);
+            else syncShuffle();
+        }
         if (!isPlaying) playPauseClicked();
     }
 }
@@ -1,32 +1,40 @@
 #pragma once
 #include <QtWidgets/QWidget>
-#include <QListWidget>
+#include <QListView>
+#include <QLineEdit>
 #include <QPushButton>
 #include <QLabel>
 #include <QSlider>
 #include <QTimer>
 #include <QMap>
+#include <QSharedPointer>
 #include <QComboBox>
 #include <QIcon>
 #include <QInputDialog>
 #include <QKeyEvent>
+#include <QDragEnterEvent>
+#include <QDropEvent>
+#include <QFileSystemWatcher>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QThreadPool>
+#include <QAtomicInt>
 #include "miniaudio.h"
-
-// --- 1. تعريف العقدة (SurahNode) ---
-struct SurahNode {
-    QString name;
-    QString path;
-    SurahNode* next = nullptr;
-    SurahNode* prev = nullptr;
-};
-
-// --- 2. تعريف هيكل قائمة التشغيل (Playlist) ---
-struct Playlist {
-    QString name;
-    SurahNode* head = nullptr;
-    SurahNode* tail = nullptr;
-    QString iconPath;
-};
+#include "Playlist.h"
+#include "EditJournal.h"
+#include "PlaylistRegistry.h"
+#include "ShuffleEngine.h"
+#include "PlaybackOrder.h"
+#include "PlayQueue.h"
+#include "TrackPreloader.h"
+#include "PlaylistSorter.h"
+#include "TrackCatalog.h"
+#include "PlaylistModel.h"
+#include "SmartPlaylistEngine.h"
+#include "LibraryScanner.h"
+#include "AudioFormat.h"
+#include "LibraryCache.h"
+#include "MetadataReader.h"
 
 class AudioPlayer : public QWidget
 {
@@ -35,8 +43,17 @@ public:
     AudioPlayer(QWidget* parent = nullptr);
     ~AudioPlayer();
 
+    // إضافة ملفات أو مجلدات كاملة للقائمة الحالية دفعة واحدة (سطر الأوامر / السحب والإفلات).
+    // المجلدات تُقرأ في الخلفية، والسور تظهر في القائمة عند انتهاء قراءتها
+    void importPaths(const QStringList& paths);
+
+    // أقصى عدد خطوات تراجع محفوظة في هذه الجلسة
+    void setUndoLimit(int limit);
+
 protected:
     void keyPressEvent(QKeyEvent* event) override;
+    void dragEnterEvent(QDragEnterEvent* event) override;
+    void dropEvent(QDropEvent* event) override;
 
 private slots:
     void playPauseClicked();
@@ -44,7 +61,7 @@ private slots:
     void nextClicked();
     void prevClicked();
     void restartClicked();
-    void onPlaylistDoubleClicked(QListWidgetItem* item);
+    void onPlaylistDoubleClicked(const QModelIndex& index);
     void updateProgress();
     void seekTo(int value);
     void setVolume(int value);
@@ -52,21 +69,96 @@ private slots:
     void addSurahClicked();
     void playlistSelectionChanged(int index);
     void createNewPlaylistClicked();
+    void createSmartPlaylistClicked();
     void renamePlaylistClicked();
+    void undoClicked();
+    void redoClicked();
+    void shuffleToggled(bool checked);
+    void enqueueSelectedClicked();
+    void playNextSelectedClicked();
+    void showPlaylistContextMenu(const QPoint& pos);
+    void sortRequested(int index);
+    void sortOrderToggled(bool descending);
+    void trackAdded(TrackId trackId);
+    void trackChanged(TrackId trackId, int fields);
+    void applySmartChanges();
+    void expireSmartPlaylists();
+    void tracksDropped(const QList<int>& rows, int targetRow);
+    void moveSelectedUpClicked();
+    void moveSelectedDownClicked();
+    void searchTextChanged(const QString& text);
+    void scanFilesFound(const QStringList& paths);
+    void scanFilesChanged(const QStringList& paths);
+    void scanFilesRemoved(const QStringList& paths);
+    void scanFilesRenamed(const QStringList& oldPaths, const QStringList& newPaths);
+    void scanRootMissing(const QString& root);
+    void scanFinished();
+    void libraryDirectoryChanged(const QString& path);
+    void rescanDirtyDirectories();
+    void pollUnwatchedDirectories();
+    void readPendingMetadata();
+    void metadataRead(const QVector<MetadataReader::Result>& results);
+    void durationsRead(const QVector<MetadataReader::Result>& results);
 
 private:
     void setupUi();
     void setupDefaultPlaylists();
-    void renamePlaylist(const QString& oldName, const QString& newName);
-    void addSurahToActiveList(QString name, QString filename, bool isAbsolutePath = false);
-    bool deleteSurahFromActiveList(const QString& name);
+    void renamePlaylist(PlaylistId id, const QString& newName);
+    int importFiles(const QSharedPointer<Playlist>& list, const QStringList& filePaths);
+    void importCollected(PlaylistId playlistId, const QStringList& filePaths);
+    // على خيط importPool
+    static QStringList collectAudioFiles(const QStringList& paths, const QAtomicInt& canceled);
+    bool isDisplayed(const Playlist& list) const;
+
+    // العمليات الأساسية على الصفوف (تحدّث القائمة والعرض، ولا تسجل في سجل التعديلات)
+    void insertRows(Playlist& list, int row, const QVector<PathId>& pathIds);
+    QVector<PathId> removeRows(Playlist& list, int row, int count);
+    void reorderRows(Playlist& list, const QVector<int>& oldRows);
+    void setCurrentRow(int row);
+    // نقل بدون تسجيل (مثل insertRows/removeRows)، بنفس معنى Playlist::moveRange
+    void moveTracks(Playlist& list, int row, int count, int newRow);
+    void moveActiveRows(EditStep& step, int row, int count, int newRow);
+    void moveRowsTo(const QList<int>& rows, int targetRow);
+    void moveSelectionBy(const QList<int>& rows, int offset);
+    bool canMoveRows();
+    bool isSmartActive() const;
+    void scheduleSmartChanges();
+    // false = لم يبق في القائمة شيء من السور التي سجلها التعديل
+    bool applyEdit(const PlaylistEdit& edit, bool reverse);
     void deleteList(Playlist& list);
+    int loadLibraryCache(Playlist& list);
+    // سور cache تحت BASE_PATH: الجديدة على الفهرس تدخله ببياناتها، وما ليس في list يُضاف لآخرها
+    int addCachedTracks(Playlist& list, const LibraryCache& cache);
+    void saveLibraryCache();
+    // القوائم كما حُفظت في LibraryIndex، false = لا يوجد فهرس صالح (تُبنى من library.cache)
+    bool restoreLibraryIndex();
+    void buildRestoredIndexes(const QVector<PathId>& pathIds);
+    void saveLibraryIndex();
+    // مسارات سور القوائم تحت BASE_PATH التي ليست في cache (بعد فحص كامل)
+    QStringList missingLibraryTracks(const LibraryCache& cache) const;
+    PlaylistId addSmartPlaylist(const QString& name, const SmartRule& rule);
+    // شروط القوائم الذكية تُحفظ بجانب القوائم العادية، وأعضاؤها يُبنون من الفهرس عند البدء
+    void restoreSmartPlaylists();
+    void saveSmartPlaylists();
+    void updateLibraryWatch();
     bool loadTrack(SurahNode* node);
+    SurahNode* nextTrack();
+    SurahNode* previousTrack();
+    void syncShuffle();
+    // false = لا توجد قائمة تشغيل أو السورة ليست فيها (نكمل بروابط next/prev)
+    bool syncPlayOrder(SurahNode* from);
+    QList<int> selectedRows() const;
+    void queueSelected(bool playNext);
+    void preloadNext();
     void updateUiState();
     QString formatTime(ma_uint64 frames, ma_uint32 sampleRate);
+    void setTotalFrames(ma_uint64 frames);
+    void countPlay();
 
     // عناصر الواجهة
-    QListWidget* playlistWidget;
+    QLineEdit* searchEdit;
+    QListView* playlistView;
+    PlaylistModel* playlistModel;
     QLabel* statusLabel;
     QLabel* currentTimeLabel;
     QLabel* totalTimeLabel;
@@ -78,28 +170,84 @@ private:
     QPushButton* nextBtn;
     QPushButton* prevBtn;
     QPushButton* restartBtn;
+    QPushButton* shuffleBtn;
     QPushButton* addBtn;
     QPushButton* deleteBtn;
     QPushButton* createPlaylistBtn;
     QPushButton* renamePlaylistBtn;
+    QPushButton* smartPlaylistBtn;
     QComboBox* playlistSelector;
+    QAction* moveUpAction;
+    QAction* moveDownAction;
+    QComboBox* sortSelector;
+    QPushButton* sortDescendingBtn;
     QLabel* albumArtLabel;
 
     // متغيرات النظام
-    QMap<QString, Playlist> allPlaylists;
-    Playlist* activePlaylist = nullptr;
+    // القوائم محفوظة بأرقام ثابتة ومؤشرات مشتركة،
+    // والمشغل يحتفظ بنسخته من المؤشر فتبقى القائمة حية أثناء التشغيل
+    PlaylistRegistry playlists;
+    QSharedPointer<Playlist> activePlaylist;      // القائمة المعروضة
+    QSharedPointer<Playlist> playingPlaylist;     // القائمة التي يتنقل فيها المشغل
     SurahNode* currentSurah = nullptr;
+    EditJournal journal;
+    ShuffleEngine shuffle;
+    bool shuffleEnabled = false;
+    // ترتيب playingPlaylist وقت بدء التشغيل منها، فتعديل القائمة لا يغير ما يُشغل بعد الحالية
+    PlaybackOrder playOrder;
+    PlayQueue playQueue;
+    SurahNode* resumeSurah = nullptr;   // موضع القائمة الذي نعود إليه بعد انتهاء الطابور
+
+    // فحص BASE_PATH عند البدء يجري في الخلفية ويملأ القائمة الافتراضية على دفعات
+    LibraryScanner* scanner;
+    PlaylistId scanPlaylistId = INVALID_PLAYLIST_ID;
+    QSharedPointer<LibraryCache> libraryCache;   // نتيجة آخر فحص مكتمل (أو المحفوظ من الجلسة السابقة)
+    bool libraryFromIndex = false;   // القوائم من LibraryIndex، وسور library.cache تُضاف بعد أول فحص
+    bool libraryIndexStale = false;  // LibraryIndex لم يُكتب مع library.cache الحالي: أول فحص كامل بدونه
+
+    // مراقبة مجلدات المكتبة: التنبيهات تُجمع في dirtyDirectories وتُفحص معاً بعد هدوئها،
+    // فنسخ آلاف الملفات = فحص جزئي أو اثنان للمجلدات المتأثرة فقط
+    QFileSystemWatcher* libraryWatcher;
+    QTimer* rescanTimer;
+    QElapsedTimer dirtySince;            // أقدم تنبيه لم يُفحص بعد
+    QSet<QString> dirtyDirectories;
+    // ما لم يقبله المراقب (حد النظام) يُفحص دورياً بدل التنبيهات
+    QTimer* pollTimer;
+    QStringList unwatchedDirectories;
+    bool partialScan = false;
+
+    // وسوم السور الجديدة ومددها تُقرأ في الخلفية، والسور المضافة أثناء الحدث الحالي تُرسل معاً
+    MetadataReader* metadataReader;
+    QVector<PathId> pendingMetadata;
+    bool metadataScheduled = false;
+
+    // المجلدات المسحوبة أو الممررة في سطر الأوامر تُقرأ هنا، وكذلك فهارس البدء المؤجلة
+    // (خيط واحد، فالإضافات تصل بترتيبها)
+    QThreadPool importPool;
+    QAtomicInt importsCanceled;
+
+    // تغييرات القوائم الذكية تُطبق بعد انتهاء الحدث الحالي (استيراد آلاف الملفات = دفعة واحدة)
+    SmartPlaylistEngine smartLists;
+    QVector<SmartPlaylistEngine::Change> heldSmartChanges;   // خروج السورة التي تُشغل الآن يؤجل لما بعدها
+    bool smartChangesScheduled = false;
+    QTimer* smartExpiryTimer;
 
     // Miniaudio
-    ma_decoder audioDecoder;
+    // الملف المفتوح مؤشر حتى يمكن استبداله بملف فتحه TrackPreloader مسبقاً
+    ma_decoder* audioDecoder = nullptr;
+    TrackPreloader preloader;
     ma_device audioDevice;
     ma_device_config deviceConfig;
     bool isLoaded = false;
     bool isPlaying = false;
     QTimer* timer;
-    ma_uint64 totalFrames = 0;
+    ma_uint64 totalFrames = 0;        // 0 = لم تُعرف المدة بعد (تصل من MetadataReader)
     ma_uint64 lastCursor = 0;
     int stuckCounter = 0;
+    // الاستماع الفعلي للسورة الحالية، لحساب مرات التشغيل (PLAY_COUNT_MIN_MS)
+    ma_uint64 progressCursor = 0;
+    ma_uint64 listenedFrames = 0;
+    bool playCounted = false;
 
     static void data_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount);
 };
@@ -0,0 +1,319 @@
+#include "AudioTags.h"
+#include <QFile>
+#include <QStringDecoder>
+
+// نصوص الوسوم قصيرة، وإطار أكبر من هذا صورة أو بيانات أخرى لا نحتاجها
+static const qint64 MAX_TEXT_FRAME = 64 * 1024;
+// كتلة تعليقات Vorbis أو LIST في WAV
+static const qint64 MAX_COMMENT_BLOCK = 1024 * 1024;
+// حماية من الملفات التالفة: عدد الكتل التي نمر عليها قبل أن نتوقف
+static const int MAX_BLOCKS = 256;
+
+static quint32 syncsafe(const unsigned char* bytes)
+{
+    return (quint32(bytes[0] & 0x7F) << 21) | (quint32(bytes[1] & 0x7F) << 14) | (quint32(bytes[2] & 0x7F) << 7) | (bytes[3] & 0x7F);
+}
+
+static quint32 bigEndian(const unsigned char* bytes, int count)
+{
+    quint32 value = 0;
+    for (int i = 0; i < count; ++i) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+static quint32 littleEndian(const unsigned char* bytes)
+{
+    return quint32(bytes[0]) | (quint32(bytes[1]) << 8) | (quint32(bytes[2]) << 16) | (quint32(bytes[3]) << 24);
+}
+
+static const unsigned char* bytesOf(const QByteArray& data)
+{
+    return reinterpret_cast<const unsigned char*>(data.constData());
+}
+
+bool AudioTags::isComplete() const
+{
+    return !title.isEmpty() && !reciter.isEmpty() && !album.isEmpty() && surahNumber >= 0;
+}
+
+AudioTags AudioTags::read(const QString& filePath)
+{
+    AudioTags tags;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return tags;
+
+    // وسم ID3v2 قد يسبق MP3 أو FLAC، فالصيغة تُعرف مما بعده
+    qint64 audioStart = tags.readId3v2(file, 0);
+    if (!file.seek(audioStart)) return tags;
+    QByteArray header = file.read(12);
+
+    if (header.startsWith("fLaC")) {
+        tags.readFlac(file, audioStart);
+    }
+    else if (header.size() >= 12 && (header.startsWith("RIFF") || header.startsWith("RF64")) && header.mid(8, 4) == "WAVE") {
+        tags.readWav(file);
+    }
+    else if (!tags.isComplete()) {
+        tags.readId3v1(file);
+    }
+    return tags;
+}
+
+qint64 AudioTags::readId3v2(QIODevice& file, qint64 offset)
+{
+    if (!file.seek(offset)) return offset;
+    QByteArray header = file.read(10);
+    if (header.size() < 10 || !header.startsWith("ID3")) return offset;
+
+    const unsigned char* bytes = bytesOf(header);
+    int version = bytes[3];
+    quint8 flags = bytes[5];
+    qint64 tagEnd = offset + 10 + syncsafe(bytes + 6);
+    qint64 end = tagEnd + ((flags & 0x10) ? 10 : 0);
+    // عدم التزامن على مستوى الوسم كله (قبل 2.4) والضغط (2.2) نادران في الملفات الحديثة ولا يُدعمان
+    if (version < 2 || version > 4 || ((flags & 0x80) && version < 4) || ((flags & 0x40) && version == 2)) return end;
+
+    qint64 position = offset + 10;
+    if (version >= 3 && (flags & 0x40)) {
+        // الترويسة الموسعة: حجمها في 2.3 لا يشمل خانة الحجم، وفي 2.4 يشملها
+        if (!file.seek(position)) return end;
+        QByteArray sizeBytes = file.read(4);
+        if (sizeBytes.size() < 4) return end;
+        position += version == 3 ? 4 + bigEndian(bytesOf(sizeBytes), 4) : syncsafe(bytesOf(sizeBytes));
+    }
+
+    int idLength = version == 2 ? 3 : 4;
+    int headerLength = version == 2 ? 6 : 10;
+    QString albumArtist;
+
+    for (int block = 0; block < MAX_BLOCKS && position + headerLength <= tagEnd; ++block) {
+        if (!file.seek(position)) break;
+        QByteArray frameHeader = file.read(headerLength);
+        if (frameHeader.size() < headerLength || frameHeader[0] == '\0') break;   // الحشو في آخر الوسم
+
+        const unsigned char* frameBytes = bytesOf(frameHeader);
+        QByteArray id = frameHeader.left(idLength);
+        qint64 frameSize = version == 2 ? bigEndian(frameBytes + 3, 3)
+            : version == 4 ? syncsafe(frameBytes + 4) : bigEndian(frameBytes + 4, 4);
+        position += headerLength;
+        if (frameSize <= 0 || position + frameSize > tagEnd) break;
+
+        QString* field = nullptr;
+        bool number = false;
+        if (id == "TIT2" || id == "TT2") field = &title;
+        else if (id == "TPE1" || id == "TP1") field = &reciter;
+        else if (id == "TPE2" || id == "TP2") field = &albumArtist;
+        else if (id == "TALB" || id == "TAL") field = &album;
+        else if (id == "TRCK" || id == "TRK") number = true;
+
+        // إطارات مضغوطة أو مشفرة لا تُقرأ، و "طول البيانات" (2.4) أو رقم المجموعة (2.3) يسبق النص
+        qint64 skip = 0;
+        bool readable = true;
+        if (version == 4) {
+            readable = !(frameBytes[9] & 0x0C);
+            if (frameBytes[9] & 0x01) skip = 4;
+        }
+        else if (version == 3) {
+            readable = !(frameBytes[9] & 0xC0);
+            if (frameBytes[9] & 0x20) skip = 1;
+        }
+
+        if ((field != nullptr || number) && readable && frameSize > skip && frameSize <= MAX_TEXT_FRAME) {
+            QByteArray frame = file.read(frameSize).mid(int(skip));
+            QString text = decodeId3Text(frame);
+            if (number) setSurahNumber(text);
+            else setField(*field, text);
+        }
+        position += frameSize;
+    }
+
+    // بعض الملفات تضع القارئ في "فنان الألبوم" فقط
+    setField(reciter, albumArtist);
+    return end;
+}
+
+void AudioTags::readId3v1(QIODevice& file)
+{
+    qint64 size = file.size();
+    if (size < 128 || !file.seek(size - 128)) return;
+
+    QByteArray tag = file.read(128);
+    if (tag.size() < 128 || !tag.startsWith("TAG")) return;
+
+    setField(title, decodeText(tag.mid(3, 30)));
+    setField(reciter, decodeText(tag.mid(33, 30)));
+    setField(album, decodeText(tag.mid(63, 30)));
+    // ID3v1.1: صفر ثم رقم المقطع في آخر خانة التعليق
+    if (tag[125] == '\0' && tag[126] != '\0' && surahNumber < 0) surahNumber = quint8(tag[126]);
+}
+
+void AudioTags::readFlac(QIODevice& file, qint64 offset)
+{
+    qint64 position = offset + 4;   // بعد "fLaC"
+    for (int block = 0; block < MAX_BLOCKS; ++block) {
+        if (!file.seek(position)) return;
+        QByteArray header = file.read(4);
+        if (header.size() < 4) return;
+
+        const unsigned char* bytes = bytesOf(header);
+        bool last = bytes[0] & 0x80;
+        int type = bytes[0] & 0x7F;
+        qint64 length = bigEndian(bytes + 1, 3);
+        position += 4;
+
+        // VORBIS_COMMENT، ولا يوجد منها إلا كتلة واحدة
+        if (type == 4) {
+            if (length <= MAX_COMMENT_BLOCK) readVorbisComments(file.read(length));
+            return;
+        }
+        if (last) return;
+        position += length;
+    }
+}
+
+void AudioTags::readVorbisComments(const QByteArray& block)
+{
+    const unsigned char* bytes = bytesOf(block);
+    qint64 size = block.size();
+    if (size < 4) return;
+
+    // كل الأطوال little-endian: اسم البرنامج، ثم عدد التعليقات، ثم "KEY=value" بـ UTF-8
+    qint64 position = 4 + qint64(littleEndian(bytes));
+    if (position + 4 > size) return;
+    quint32 count = littleEndian(bytes + position);
+    position += 4;
+
+    QString albumArtist;
+    for (quint32 i = 0; i < count && position + 4 <= size; ++i) {
+        qint64 length = littleEndian(bytes + position);
+        position += 4;
+        if (position + length > size) return;
+
+        QString comment = QString::fromUtf8(block.constData() + position, int(length));
+        position += length;
+
+        int separator = comment.indexOf('=');
+        if (separator <= 0) continue;
+        QString key = comment.left(separator).toUpper();
+        QString value = comment.mid(separator + 1);
+
+        if (key == "TITLE") setField(title, value);
+        else if (key == "ARTIST") setField(reciter, value);
+        else if (key == "ALBUMARTIST") setField(albumArtist, value);
+        else if (key == "ALBUM") setField(album, value);
+        else if (key == "TRACKNUMBER") setSurahNumber(value);
+    }
+    setField(reciter, albumArtist);
+}
+
+void AudioTags::readWav(QIODevice& file)
+{
+    qint64 size = file.size();
+    qint64 position = 12;   // بعد "RIFF" والحجم و "WAVE"
+
+    for (int block = 0; block < MAX_BLOCKS && position + 8 <= size; ++block) {
+        if (!file.seek(position)) return;
+        QByteArray header = file.read(8);
+        if (header.size() < 8) return;
+
+        QByteArray id = header.left(4);
+        quint32 length = littleEndian(bytesOf(header) + 4);
+        // في RF64 الحجم الحقيقي لكتلة البيانات في ds64، وما بعدها لا نحتاجه عادة
+        if (length == 0xFFFFFFFFu) return;
+        qint64 body = position + 8;
+
+        if (id == "LIST" && length >= 4 && length <= MAX_COMMENT_BLOCK) {
+            QByteArray list = file.read(length);
+            if (list.startsWith("INFO")) {
+                // كتل فرعية: معرف، حجم، نص منتهٍ بصفر، وكل كتلة بطول زوجي
+                int offset = 4;
+                while (offset + 8 <= list.size()) {
+                    QByteArray subId = list.mid(offset, 4);
+                    int subLength = int(littleEndian(bytesOf(list) + offset + 4));
+                    offset += 8;
+                    if (subLength < 0 || offset + subLength > list.size()) break;
+
+                    QString text = decodeText(list.mid(offset, subLength));
+                    if (subId == "INAM") setField(title, text);
+                    else if (subId == "IART") setField(reciter, text);
+                    else if (subId == "IPRD") setField(album, text);
+                    else if (subId == "ITRK" || subId == "IPRT") setSurahNumber(text);
+                    offset += subLength + (subLength & 1);
+                }
+            }
+        }
+        else if (id == "id3 " || id == "ID3 ") {
+            readId3v2(file, body);
+        }
+
+        position = body + length + (length & 1);
+    }
+}
+
+void AudioTags::setField(QString& field, const QString& value)
+{
+    if (field.isEmpty()) field = value.trimmed();
+}
+
+void AudioTags::setSurahNumber(const QString& value)
+{
+    if (surahNumber >= 0) return;
+
+    // "2/114" أو "002"، ويقبل الأرقام العربية ٠-٩
+    int number = -1;
+    for (const QChar& c : value.trimmed()) {
+        int digit = c.digitValue();
+        if (digit < 0) break;
+        number = (number < 0 ? 0 : number * 10) + digit;
+        if (number > 100000) return;
+    }
+    if (number > 0) surahNumber = number;
+}
+
+QString AudioTags::decodeText(const QByteArray& bytes)
+{
+    int length = bytes.indexOf('\0');
+    QByteArray text = length < 0 ? bytes : bytes.left(length);
+
+    // الوسوم القديمة بلا ترميز محدد: UTF-8 إن كانت صالحة، وإلا صفحة ترميز النظام
+    // (Windows-1256 على الأنظمة العربية)
+    QStringDecoder utf8(QStringDecoder::Utf8);
+    QString decoded = utf8(text);
+    if (utf8.hasError()) decoded = QString::fromLocal8Bit(text);
+    return decoded.trimmed();
+}
+
+QString AudioTags::decodeId3Text(const QByteArray& frame)
+{
+    if (frame.isEmpty()) return QString();
+
+    QByteArray text = frame.mid(1);
+    QString decoded;
+    switch (frame[0]) {
+    case 0:
+        return decodeText(text);
+    case 1: {
+        // UTF-16 بعلامة ترتيب البايتات
+        QStringDecoder utf16(QStringDecoder::Utf16);
+        decoded = utf16(text);
+        break;
+    }
+    case 2: {
+        QStringDecoder utf16(QStringDecoder::Utf16BE);
+        decoded = utf16(text);
+        break;
+    }
+    case 3:
+        decoded = QString::fromUtf8(text);
+        break;
+    default:
+        return QString();
+    }
+
+    // عدة قيم مفصولة بصفر (2.4): الأولى فقط
+    int end = decoded.indexOf(QChar(0));
+    if (end >= 0) decoded.truncate(end);
+    return decoded.trimmed();
+}
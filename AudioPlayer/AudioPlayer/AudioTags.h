@@ -0,0 +1,37 @@
+#pragma once
+#include <QString>
+#include <QByteArray>
+
+class QIODevice;
+
+// --- قراءة الوسوم (AudioTags) ---
+// العنوان والقارئ والألبوم ورقم السورة من وسوم الملف فقط، بدون فك الصوت:
+// ID3v2 (و ID3v1 في آخر الملف) في MP3، تعليقات Vorbis في FLAC، و LIST/INFO أو id3 في WAV.
+// ما لا نحتاجه (الصور، بيانات الصوت) يُقفز فوقه بـ seek ولا يُقرأ.
+class AudioTags {
+public:
+    QString title;
+    QString reciter;
+    QString album;
+    int surahNumber = -1;   // رقم المقطع في الوسم (TRCK / TRACKNUMBER)
+
+    bool isComplete() const;
+
+    // وسوم الملف، أو قيم فارغة إن لم يكن فيه وسم مفهوم
+    static AudioTags read(const QString& filePath);
+
+private:
+    // كل دالة تكمل الحقول الفارغة فقط، فالوسم الأول في الملف له الأولوية.
+    // readId3v2 تعيد موضع ما بعد الوسم (أو offset إن لم يوجد وسم)
+    qint64 readId3v2(QIODevice& file, qint64 offset);
+    void readId3v1(QIODevice& file);
+    void readFlac(QIODevice& file, qint64 offset);
+    void readWav(QIODevice& file);
+    void readVorbisComments(const QByteArray& block);
+
+    void setField(QString& field, const QString& value);
+    void setSurahNumber(const QString& value);
+
+    static QString decodeText(const QByteArray& bytes);
+    static QString decodeId3Text(const QByteArray& frame);
+};
@@ -0,0 +1,280 @@
+#include "EditJournal.h"
+#include <QHash>
+#include <QSet>
+#include <algorithm>
+
+EditJournal::EditJournal(int limit) : maxSteps(qMax(0, limit))
+{
+}
+
+void EditJournal::setLimit(int limit)
+{
+    maxSteps = qMax(0, limit);
+    trim();
+}
+
+void EditJournal::record(const EditStep& step)
+{
+    if (step.isEmpty() || maxSteps == 0) return;
+
+    undoSteps.append(step);
+    redoSteps.clear();
+    trim();
+}
+
+void EditJournal::clear()
+{
+    undoSteps.clear();
+    redoSteps.clear();
+}
+
+EditStep EditJournal::takeUndo()
+{
+    if (undoSteps.isEmpty()) return EditStep();
+
+    EditStep step = undoSteps.takeLast();
+    redoSteps.append(step);
+    return step;
+}
+
+EditStep EditJournal::takeRedo()
+{
+    if (redoSteps.isEmpty()) return EditStep();
+
+    EditStep step = redoSteps.takeLast();
+    undoSteps.append(step);
+    return step;
+}
+
+void EditJournal::dropUndone()
+{
+    if (!redoSteps.isEmpty()) redoSteps.removeLast();
+}
+
+void EditJournal::dropRedone()
+{
+    if (!undoSteps.isEmpty()) undoSteps.removeLast();
+}
+
+void EditJournal::repath(PathId oldCanonicalId, PathId newPathId)
+{
+    const PathTable& table = PathTable::instance();
+    auto update = [&table, oldCanonicalId, newPathId](QList<EditStep>& steps) {
+        for (EditStep& step : steps) {
+            for (PlaylistEdit& edit : step) {
+                for (PathId& pathId : edit.pathIds) {
+                    if (table.canonicalId(pathId) == oldCanonicalId) pathId = newPathId;
+                }
+                if (edit.anchor != INVALID_PATH_ID && table.canonicalId(edit.anchor) == oldCanonicalId) {
+                    edit.anchor = newPathId;
+                }
+            }
+        }
+    };
+    update(undoSteps);
+    update(redoSteps);
+}
+
+void EditJournal::trim()
+{
+    while (undoSteps.size() > maxSteps) {
+        undoSteps.removeFirst();
+    }
+    while (redoSteps.size() > maxSteps) {
+        redoSteps.removeFirst();
+    }
+}
+
+// ------------------------------------------------------------
+// ترجمة التعديلات المسجلة لصفوف القائمة الحالية
+// ------------------------------------------------------------
+
+EditStep EditJournal::resolve(const Playlist& list, const PlaylistEdit& edit, bool reverse)
+{
+    EditStep operations;
+    if (edit.type == PlaylistEdit::RenamePlaylist) return operations;
+
+    PlaylistEdit operation;
+    operation.type = edit.type;
+    operation.playlistId = edit.playlistId;
+
+    if (edit.type == PlaylistEdit::ReorderRows) {
+        QVector<PathId> order;
+        if (reverse) {
+            order = edit.pathIds;
+        }
+        else {
+            order.reserve(edit.rowOrder.size());
+            for (int row : edit.rowOrder) {
+                order.append(edit.pathIds[row]);
+            }
+        }
+        operation.rowOrder = arrangedRows(list, order);
+        if (!operation.rowOrder.isEmpty()) operations.append(operation);
+        return operations;
+    }
+
+    if (edit.type == PlaylistEdit::MoveRows) {
+        int from = reverse ? edit.newRow : edit.row;
+        int to = reverse ? edit.row : edit.newRow;
+        int row = findRows(list, from, edit.pathIds);
+        if (row == -1) return operations;
+
+        // ما أضافه الفحص أو حذفه قبل السور أزاحها وأزاح مكانها الجديد بنفس القدر
+        operation.row = row;
+        operation.count = edit.pathIds.size();
+        operation.newRow = qBound(0, to + row - from, list.count() - operation.count);
+        operation.pathIds = edit.pathIds;
+        operations.append(operation);
+        return operations;
+    }
+
+    bool insert = (edit.type == PlaylistEdit::InsertRows) != reverse;
+    if (insert) {
+        operation.type = PlaylistEdit::InsertRows;
+        operation.row = insertionRow(list, edit);
+        operation.count = edit.pathIds.size();
+        operation.pathIds = edit.pathIds;
+        operations.append(operation);
+        return operations;
+    }
+
+    // السور بعد anchor مباشرة أولاً (السورة المكررة قد تطابق صفاً أقرب لـ row)
+    int row = insertionRow(list, edit);
+    if (!rowsMatch(list, row, edit.pathIds)) row = findRows(list, edit.row, edit.pathIds);
+    if (row == -1) {
+        // الصفوف تفرقت بتغييرات لا تُسجل (مثل إضافة المراقب لملف بينها)
+        return scatteredRemoval(list, edit);
+    }
+    operation.type = PlaylistEdit::RemoveRows;
+    operation.row = row;
+    operation.count = edit.pathIds.size();
+    operation.pathIds = edit.pathIds;
+    operations.append(operation);
+    return operations;
+}
+
+bool EditJournal::rowsMatch(const Playlist& list, int row, const QVector<PathId>& pathIds)
+{
+    SurahNode* node = list.at(row);
+    for (PathId pathId : pathIds) {
+        if (node == nullptr || node->pathId != pathId) return false;
+        node = node->next;
+    }
+    return true;
+}
+
+int EditJournal::findRows(const Playlist& list, int row, const QVector<PathId>& pathIds)
+{
+    if (pathIds.isEmpty()) return -1;
+    if (rowsMatch(list, row, pathIds)) return row;
+
+    PathId first = pathIds.first();
+    PathId trackId = PathTable::instance().canonicalId(first);
+    int nearest = -1;
+    for (auto it = list.pathIndex.constFind(trackId); it != list.pathIndex.constEnd() && it.key() == trackId; ++it) {
+        if (it.value()->pathId != first) continue;
+        int candidate = list.indexOf(it.value());
+        if (nearest != -1 && qAbs(candidate - row) >= qAbs(nearest - row)) continue;
+        if (rowsMatch(list, candidate, pathIds)) nearest = candidate;
+    }
+    return nearest;
+}
+
+int EditJournal::insertionRow(const Playlist& list, const PlaylistEdit& edit)
+{
+    if (edit.row <= 0) return 0;
+    if (edit.anchor != INVALID_PATH_ID) {
+        // أقرب نسخة من السورة التي كانت قبلها للصف المسجل
+        PathId trackId = PathTable::instance().canonicalId(edit.anchor);
+        int nearest = -1;
+        for (auto it = list.pathIndex.constFind(trackId); it != list.pathIndex.constEnd() && it.key() == trackId; ++it) {
+            if (it.value()->pathId != edit.anchor) continue;
+            int candidate = list.indexOf(it.value());
+            if (nearest == -1 || qAbs(candidate - (edit.row - 1)) < qAbs(nearest - (edit.row - 1))) nearest = candidate;
+        }
+        if (nearest != -1) return nearest + 1;
+    }
+    // السورة التي كانت قبلها حُذفت أيضاً (أو تعديل قديم بلا anchor)
+    return qBound(0, edit.row, list.count());
+}
+
+QVector<int> EditJournal::arrangedRows(const Playlist& list, const QVector<PathId>& order)
+{
+    // كل سورة من order تأخذ صفاً من الصفوف التي تشغلها سور order الآن، بترتيب order.
+    // السورة المكررة تُحسب بعدد مرات تكرارها، وما أضيف بعد التعديل لا يتحرك
+    QHash<PathId, int> wanted;
+    wanted.reserve(order.size());
+    for (PathId pathId : order) {
+        wanted[pathId]++;
+    }
+
+    QVector<int> places;
+    QHash<PathId, QVector<int>> rowsOf;
+    int row = 0;
+    for (SurahNode* node = list.head; node != nullptr; node = node->next, ++row) {
+        auto it = wanted.find(node->pathId);
+        if (it == wanted.end() || it.value() == 0) continue;
+        it.value()--;
+        places.append(row);
+        rowsOf[node->pathId].append(row);
+    }
+    if (places.isEmpty()) return QVector<int>();
+
+    QVector<int> oldRows(list.count());
+    for (int i = 0; i < oldRows.size(); ++i) {
+        oldRows[i] = i;
+    }
+    QHash<PathId, int> taken;
+    int place = 0;
+    for (PathId pathId : order) {
+        auto it = rowsOf.constFind(pathId);
+        if (it == rowsOf.constEnd()) continue;
+        int& next = taken[pathId];
+        if (next == it.value().size()) continue;
+        oldRows[places[place++]] = it.value()[next++];
+    }
+    return oldRows;
+}
+
+EditStep EditJournal::scatteredRemoval(const Playlist& list, const PlaylistEdit& edit)
+{
+    // السورة المكررة في القائمة تُحذف نسختها الأقرب للصف المسجل، وليس أول نسخة
+    const PathTable& table = PathTable::instance();
+    QSet<const SurahNode*> chosen;
+    QVector<int> rows;
+    for (PathId pathId : edit.pathIds) {
+        PathId trackId = table.canonicalId(pathId);
+        const SurahNode* nearestNode = nullptr;
+        int nearest = -1;
+        for (auto it = list.pathIndex.constFind(trackId); it != list.pathIndex.constEnd() && it.key() == trackId; ++it) {
+            if (chosen.contains(it.value())) continue;
+            int candidate = list.indexOf(it.value());
+            if (nearest == -1 || qAbs(candidate - edit.row) < qAbs(nearest - edit.row)) {
+                nearest = candidate;
+                nearestNode = it.value();
+            }
+        }
+        if (nearestNode == nullptr) continue;
+        chosen.insert(nearestNode);
+        rows.append(nearest);
+    }
+    std::sort(rows.begin(), rows.end());
+
+    // من الأسفل للأعلى حتى لا تتغير أرقام المجالات المتبقية
+    EditStep operations;
+    int end = rows.size();
+    while (end > 0) {
+        int start = end - 1;
+        while (start > 0 && rows[start - 1] == rows[start] - 1) start--;
+
+        PlaylistEdit operation;
+        operation.type = PlaylistEdit::RemoveRows;
+        operation.playlistId = edit.playlistId;
+        operation.row = rows[start];
+        operation.count = end - start;
+        operations.append(operation);
+        end = start;
+    }
+    return operations;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <QString>
+#include <QVector>
+#include <QList>
+#include "PathTable.h"
+#include "Playlist.h"
+
+// --- سجل التعديلات (للتراجع والإعادة) ---
+// كل تعديل يحفظ الفرق فقط (الصفوف وأرقام المسارات المتأثرة) وليس نسخة من القائمة،
+// فتكلفة الخطوة في الذاكرة تتناسب مع عدد السور المعدلة (4 بايت لكل سورة).
+// الفحص والمراقب والقوائم الذكية يغيرون القوائم بدون تسجيل، فالصفوف المسجلة قد تنزاح:
+// أرقام المسارات المحفوظة مع كل تعديل هي المرجع عند التطبيق، والصف مجرد تلميح لمكانها.
+struct PlaylistEdit {
+    enum Type {
+        InsertRows,     // أضيفت pathIds بدءاً من row
+        RemoveRows,     // حُذفت pathIds بدءاً من row
+        ReorderRows,    // أعيد ترتيب القائمة كلها حسب rowOrder (انظر Playlist::permute)، وpathIds ترتيبها قبله
+        MoveRows,       // نُقلت count سورة (pathIds) من row لتبدأ في newRow
+        RenamePlaylist  // oldName -> newName
+    };
+
+    Type type = InsertRows;
+    PlaylistId playlistId = INVALID_PLAYLIST_ID;
+    int row = 0;
+    // للإضافة والحذف: السورة التي كانت قبل row وقت التعديل (INVALID_PATH_ID = أول القائمة)،
+    // فتعود السور بعدها حتى لو أضاف الفحص أو حذف صفوفاً فوقها
+    PathId anchor = INVALID_PATH_ID;
+    int count = 0;
+    int newRow = 0;
+    QVector<PathId> pathIds;
+    QVector<int> rowOrder;
+    QString oldName;
+    QString newName;
+};
+
+// خطوة واحدة يراها المستخدم (مثلاً حذف عدة مجالات مرة واحدة) قد تحتوي عدة تعديلات
+typedef QVector<PlaylistEdit> EditStep;
+
+class EditJournal {
+public:
+    explicit EditJournal(int limit = 100);
+
+    // أقصى عدد خطوات محفوظة، الأقدم يُحذف أولاً
+    void setLimit(int limit);
+    int limit() const { return maxSteps; }
+
+    void record(const EditStep& step);
+    void clear();
+
+    bool canUndo() const { return !undoSteps.isEmpty(); }
+    bool canRedo() const { return !redoSteps.isEmpty(); }
+
+    // تعيد الخطوة التي يجب عكسها/إعادة تطبيقها وتنقلها للمكدس الآخر
+    EditStep takeUndo();
+    EditStep takeRedo();
+    // الخطوة التي أخذتها takeUndo/takeRedo للتو تعذر تطبيقها (سورها لم تعد في القائمة)
+    void dropUndone();
+    void dropRedone();
+
+    // ملف أعيدت تسميته: العقد أخذت المسار الجديد، والخطوات المحفوظة كذلك
+    void repath(PathId oldCanonicalId, PathId newPathId);
+
+    // يترجم التعديل (أو عكسه) لعمليات على صفوف list الحالية، تُطبق بالترتيب كما هي:
+    // InsertRows (row, pathIds)، RemoveRows (row, count)، MoveRows (row, count, newRow)
+    // أو ReorderRows (rowOrder، وقد يكون هو نفس الترتيب). لا يغير list ولا يترجم RenamePlaylist.
+    // قائمة فارغة = لم يبق في القائمة شيء من السور التي سجلها التعديل
+    static EditStep resolve(const Playlist& list, const PlaylistEdit& edit, bool reverse);
+
+private:
+    void trim();
+
+    static bool rowsMatch(const Playlist& list, int row, const QVector<PathId>& pathIds);
+    // أقرب صف لـ row تبدأ منه pathIds متتالية، -1 = لم تعد متتالية في القائمة
+    static int findRows(const Playlist& list, int row, const QVector<PathId>& pathIds);
+    // الصف الذي تعود إليه سور حُذفت (أو أضيفت) بعد anchor
+    static int insertionRow(const Playlist& list, const PlaylistEdit& edit);
+    // ترتيب يضع السور الموجودة من order بترتيبها فيه، وما لم يسجله التعديل يبقى في صفه
+    static QVector<int> arrangedRows(const Playlist& list, const QVector<PathId>& order);
+    // السور تفرقت: أقرب نسخة لـ row من كل سورة، مجالات متتالية من الأسفل للأعلى
+    static EditStep scatteredRemoval(const Playlist& list, const PlaylistEdit& edit);
+
+    int maxSteps;
+    QList<EditStep> undoSteps;
+    QList<EditStep> redoSteps;
+};
@@ -0,0 +1,186 @@
+#include "LibraryCache.h"
+#include "TrackCatalog.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDir>
+#include <QStandardPaths>
+
+static const quint32 CACHE_MAGIC = 0x51504C43;   // "QPLC"
+// 2: رقم السورة وعلامة قراءة الوسوم (الإصدار 1 يُقرأ، ووسومه تُقرأ من الملفات من جديد)
+// 3: تاريخ الإضافة ومرات التشغيل (الأقدم يُقرأ، وسوره تُعتبر مضافة الآن)
+static const quint32 CACHE_VERSION = 3;
+
+QString LibraryCache::defaultPath()
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dir);
+    return dir + "/library.cache";
+}
+
+QString LibraryCache::childPath(const QString& directory, const QString& name)
+{
+    // جذر القرص ("D:/") هو المجلد الوحيد الذي ينتهي بشرطة بعد cleanPath
+    return directory.endsWith('/') ? directory + name : directory + '/' + name;
+}
+
+bool LibraryCache::load(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic = 0, version = 0;
+    stream >> magic >> version;
+    // صيغة قديمة أو ملف تالف: فحص كامل من جديد
+    if (magic != CACHE_MAGIC || version < 1 || version > CACHE_VERSION) return false;
+
+    quint32 directoryCount = 0;
+    stream >> directoryCount;
+
+    QHash<QString, DirectoryRecord> loaded;
+    loaded.reserve(int(directoryCount));
+    for (quint32 i = 0; i < directoryCount && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        DirectoryRecord record;
+        quint32 fileCount = 0;
+        stream >> path >> record.modified >> record.subdirectories >> fileCount;
+
+        record.files.reserve(int(fileCount));
+        for (quint32 j = 0; j < fileCount && stream.status() == QDataStream::Ok; ++j) {
+            FileRecord fileRecord;
+            quint8 format = 0;
+            stream >> fileRecord.name >> fileRecord.size >> fileRecord.modified >> format
+                >> fileRecord.durationMs >> fileRecord.title >> fileRecord.reciter >> fileRecord.album;
+            if (version >= 2) stream >> fileRecord.surahNumber >> fileRecord.tagsRead;
+            if (version >= 3) stream >> fileRecord.addedAt >> fileRecord.playCount;
+            fileRecord.format = AudioFormat::Type(format);
+            record.files.append(fileRecord);
+        }
+        loaded.insert(path, record);
+    }
+
+    if (stream.status() != QDataStream::Ok) return false;
+    directories.swap(loaded);
+    return true;
+}
+
+bool LibraryCache::save(const QString& filePath) const
+{
+    // QSaveFile يكتب في ملف مؤقت ثم يستبدل القديم، فانقطاع الكتابة لا يترك فهرساً ناقصاً
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream << CACHE_MAGIC << CACHE_VERSION << quint32(directories.size());
+
+    for (auto it = directories.constBegin(); it != directories.constEnd(); ++it) {
+        const DirectoryRecord& record = it.value();
+        stream << it.key() << record.modified << record.subdirectories << quint32(record.files.size());
+        for (const FileRecord& fileRecord : record.files) {
+            stream << fileRecord.name << fileRecord.size << fileRecord.modified << quint8(fileRecord.format)
+                << fileRecord.durationMs << fileRecord.title << fileRecord.reciter << fileRecord.album
+                << fileRecord.surahNumber << fileRecord.tagsRead << fileRecord.addedAt << fileRecord.playCount;
+        }
+    }
+
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+bool LibraryCache::isUnder(const QString& path, const QString& root)
+{
+    if (!path.startsWith(root)) return false;
+    return path.size() == root.size() || root.endsWith('/') || path[root.size()] == '/';
+}
+
+void LibraryCache::replaceUnder(const QStringList& roots, const LibraryCache& other)
+{
+    for (auto it = directories.begin(); it != directories.end();) {
+        bool replaced = false;
+        for (const QString& root : roots) {
+            if (isUnder(it.key(), root)) {
+                replaced = true;
+                break;
+            }
+        }
+        if (replaced) it = directories.erase(it);
+        else ++it;
+    }
+    for (auto it = other.directories.constBegin(); it != other.directories.constEnd(); ++it) {
+        directories.insert(it.key(), it.value());
+    }
+}
+
+const LibraryCache::DirectoryRecord* LibraryCache::directory(const QString& path) const
+{
+    auto it = directories.constFind(path);
+    return it == directories.constEnd() ? nullptr : &it.value();
+}
+
+void LibraryCache::setDirectory(const QString& path, const DirectoryRecord& record)
+{
+    directories.insert(path, record);
+}
+
+QVector<LibraryCache::Track> LibraryCache::tracks(const QString& root) const
+{
+    QVector<Track> result;
+
+    // مكدس بدل التعاود، والمجلدات الفرعية تُدفع بعكس ترتيبها حتى تخرج بترتيبها
+    QStringList pending;
+    pending << QDir::cleanPath(root);
+    while (!pending.isEmpty()) {
+        QString path = pending.takeLast();
+        const DirectoryRecord* record = directory(path);
+        if (record == nullptr) continue;
+
+        for (const FileRecord& fileRecord : record->files) {
+            if (fileRecord.format == AudioFormat::Unknown) continue;
+            Track track;
+            track.path = childPath(path, fileRecord.name);
+            track.record = fileRecord;
+            result.append(track);
+        }
+        for (int i = record->subdirectories.size() - 1; i >= 0; --i) {
+            pending.append(childPath(path, record->subdirectories[i]));
+        }
+    }
+    return result;
+}
+
+void LibraryCache::updateDerived(const TrackCatalog& catalog)
+{
+    const PathTable& table = PathTable::instance();
+    for (auto it = directories.begin(); it != directories.end(); ++it) {
+        for (FileRecord& fileRecord : it.value().files) {
+            if (fileRecord.format == AudioFormat::Unknown) continue;
+            PathId pathId = table.find(childPath(it.key(), fileRecord.name));
+            if (pathId == INVALID_PATH_ID) continue;
+
+            const TrackInfo& info = catalog.info(pathId);
+            fileRecord.durationMs = info.durationMs;
+            fileRecord.title = catalog.title(pathId);
+            fileRecord.reciter = catalog.reciter(pathId);
+            fileRecord.album = catalog.album(pathId);
+            fileRecord.surahNumber = info.surahNumber;
+            fileRecord.tagsRead = info.tagsRead;
+            fileRecord.addedAt = info.addedAt;
+            fileRecord.playCount = info.playCount;
+        }
+    }
+}
+
+void LibraryCache::updateFileSizes(TrackCatalog& catalog) const
+{
+    const PathTable& table = PathTable::instance();
+    for (auto it = directories.constBegin(); it != directories.constEnd(); ++it) {
+        for (const FileRecord& fileRecord : it.value().files) {
+            if (fileRecord.format == AudioFormat::Unknown) continue;
+            PathId pathId = table.find(childPath(it.key(), fileRecord.name));
+            if (pathId != INVALID_PATH_ID) catalog.setFileSize(pathId, fileRecord.size);
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include "AudioFormat.h"
+
+class TrackCatalog;
+
+// --- فهرس المكتبة المحفوظ (LibraryCache) ---
+// صورة من آخر فحص لكل مجلد: وقت تعديله، مجلداته الفرعية، وملفات الصوت فيه
+// (الحجم، وقت التعديل، الصيغة، والبيانات المستخرجة مثل المدة والوسوم).
+// عند الفحص التالي:
+//  - مجلد لم يتغير وقت تعديله يُؤخذ من هنا كما هو (بدون قراءة محتواه ولا فتح ملفاته)
+//  - مجلد تغير يُقرأ من جديد، وملف لم يتغير حجمه ووقت تعديله يحتفظ ببياناته
+// ويُحفظ في AppDataLocation، فالقائمة الافتراضية تظهر من هنا قبل أن يلمس الفحص القرص.
+class LibraryCache {
+public:
+    struct FileRecord {
+        QString name;               // اسم الملف داخل المجلد
+        qint64 size = 0;
+        qint64 modified = 0;        // ms منذ 1970
+        AudioFormat::Type format = AudioFormat::Unknown;
+
+        // بيانات مستخرجة، صالحة ما دام size و modified لم يتغيرا
+        qint32 durationMs = -1;
+        QString title;
+        QString reciter;
+        QString album;
+        qint16 surahNumber = -1;
+        bool tagsRead = false;      // الوسوم أعلاه قُرئت من الملف (وقد تكون فارغة)
+
+        // تاريخ السورة في المكتبة، يبقى ولو تغير الملف (0 = غير معروف)
+        qint64 addedAt = 0;
+        quint32 playCount = 0;
+    };
+
+    struct DirectoryRecord {
+        qint64 modified = 0;
+        QStringList subdirectories; // أسماء فقط، مرتبة
+        // مرتبة بالاسم، وتشمل الملفات غير الصوتية (format = Unknown) حتى لا تُفتح مرة أخرى
+        QVector<FileRecord> files;
+    };
+
+    struct Track {
+        QString path;
+        FileRecord record;
+    };
+
+    static QString defaultPath();
+    static QString childPath(const QString& directory, const QString& name);
+
+    bool load(const QString& filePath);
+    bool save(const QString& filePath) const;
+
+    // مفاتيح المجلدات مسارات مطلقة بعد QDir::cleanPath
+    const DirectoryRecord* directory(const QString& path) const;
+    void setDirectory(const QString& path, const DirectoryRecord& record);
+    int directoryCount() const { return directories.size(); }
+    QStringList directoryPaths() const { return directories.keys(); }
+
+    // path هو root نفسه أو داخله
+    static bool isUnder(const QString& path, const QString& root);
+    // يستبدل ما تحت roots بمحتوى other (نتيجة فحص جزئي لهذه المجلدات)
+    void replaceUnder(const QStringList& roots, const LibraryCache& other);
+
+    // كل ملفات الصوت في root وما تحته، مجلداً بعد مجلد (كل مجلد مرتب بالاسم)
+    QVector<Track> tracks(const QString& root) const;
+
+    // ينسخ المدد والوسوم وتاريخ الإضافة ومرات التشغيل من الفهرس إلى السجلات قبل الحفظ
+    void updateDerived(const TrackCatalog& catalog);
+    // العكس للحجم: الترتيب بالحجم يقرأ من الفهرس ولا يلمس القرص
+    void updateFileSizes(TrackCatalog& catalog) const;
+
+private:
+    QHash<QString, DirectoryRecord> directories;
+};
@@ -0,0 +1,440 @@
+#include "LibraryIndex.h"
+#include "LibraryCache.h"
+#include "TrackCatalog.h"
+#include "SearchIndex.h"
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QDebug>
+#include <cstring>
+
+static const char INDEX_MAGIC[4] = { 'Q', 'P', 'L', 'X' };
+static const quint32 INDEX_VERSION = 1;
+
+// كل الأقسام بعد الترويسة: المجلدات، السور، القوائم، الأرقام، ثم النصوص.
+// أحجام السجلات مضاعفات 8 فيبقى كل قسم على حد 8 بايت بدون حشو
+struct LibraryIndex::Header {
+    char magic[4];
+    quint32 version;
+    quint32 directoryCount;
+    quint32 trackCount;
+    quint32 playlistCount;
+    quint32 idCount;
+    qint64 cacheSize;           // بصمة library.cache عند الكتابة، -1 = لم يكن موجوداً
+    qint64 cacheModified;
+    quint64 directoriesOffset;
+    quint64 tracksOffset;
+    quint64 playlistsOffset;
+    quint64 idsOffset;
+    quint64 stringsOffset;
+    quint64 stringsSize;
+};
+
+// الملف يُقرأ كما هو، فأي تغيير في هذه الأحجام يحتاج INDEX_VERSION جديداً
+static_assert(sizeof(LibraryIndex::StringRef) == 8, "StringRef layout");
+static_assert(sizeof(LibraryIndex::TrackRecord) == 64, "TrackRecord layout");
+static_assert(sizeof(LibraryIndex::PlaylistRecord) == 32, "PlaylistRecord layout");
+
+namespace {
+
+// يجمع الأقسام في الذاكرة ثم يكتبها مرة واحدة (write وملف المقارنة في printStartupBenchmark)
+class IndexBuilder {
+public:
+    LibraryIndex::StringRef addString(const QString& text)
+    {
+        LibraryIndex::StringRef ref = { 0, 0 };
+        if (text.isEmpty()) return ref;
+
+        QByteArray utf8 = text.toUtf8();
+        auto it = stringIndex.constFind(utf8);
+        if (it != stringIndex.constEnd()) return it.value();
+
+        ref.offset = quint32(strings.size());
+        ref.length = quint32(utf8.size());
+        strings.append(utf8);
+        stringIndex.insert(utf8, ref);
+        return ref;
+    }
+
+    quint32 addDirectory(const QString& path)
+    {
+        auto it = directoryIndex.constFind(path);
+        if (it != directoryIndex.constEnd()) return it.value();
+
+        quint32 id = quint32(directories.size());
+        directories.append(addString(path));
+        directoryIndex.insert(path, id);
+        return id;
+    }
+
+    quint32 addTrack(const LibraryIndex::TrackRecord& track)
+    {
+        tracks.append(track);
+        return quint32(tracks.size() - 1);
+    }
+
+    void addPlaylist(const QString& name, const QString& iconPath, bool library, const QVector<quint32>& trackIndexes)
+    {
+        LibraryIndex::PlaylistRecord record;
+        memset(&record, 0, sizeof(record));
+        record.name = addString(name);
+        record.iconPath = addString(iconPath);
+        record.firstTrack = quint32(ids.size());
+        record.trackCount = quint32(trackIndexes.size());
+        record.flags = library ? LibraryIndex::LibraryPlaylist : 0;
+        playlists.append(record);
+        ids += trackIndexes;
+    }
+
+    bool save(const QString& filePath, const QString& cachePath) const;
+
+    QVector<LibraryIndex::StringRef> directories;
+    QVector<LibraryIndex::TrackRecord> tracks;
+
+private:
+    QByteArray strings;
+    QHash<QByteArray, LibraryIndex::StringRef> stringIndex;
+    QHash<QString, quint32> directoryIndex;
+    QVector<LibraryIndex::PlaylistRecord> playlists;
+    QVector<quint32> ids;
+};
+
+}
+
+bool IndexBuilder::save(const QString& filePath, const QString& cachePath) const
+{
+    LibraryIndex::Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = INDEX_VERSION;
+    header.directoryCount = quint32(directories.size());
+    header.trackCount = quint32(tracks.size());
+    header.playlistCount = quint32(playlists.size());
+    header.idCount = quint32(ids.size());
+
+    QFileInfo cacheInfo(cachePath);
+    header.cacheSize = cacheInfo.exists() ? cacheInfo.size() : -1;
+    header.cacheModified = cacheInfo.exists() ? cacheInfo.lastModified().toMSecsSinceEpoch() : -1;
+
+    header.directoriesOffset = sizeof(header);
+    header.tracksOffset = header.directoriesOffset + quint64(directories.size()) * sizeof(LibraryIndex::StringRef);
+    header.playlistsOffset = header.tracksOffset + quint64(tracks.size()) * sizeof(LibraryIndex::TrackRecord);
+    header.idsOffset = header.playlistsOffset + quint64(playlists.size()) * sizeof(LibraryIndex::PlaylistRecord);
+    header.stringsOffset = header.idsOffset + quint64(ids.size()) * sizeof(quint32);
+    header.stringsSize = quint64(strings.size());
+
+    // QSaveFile: الفهرس القديم يبقى كاملاً إن انقطعت الكتابة
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    auto writeBlock = [&file](const void* block, qint64 size) {
+        return size == 0 || file.write(static_cast<const char*>(block), size) == size;
+    };
+    bool ok = writeBlock(&header, sizeof(header))
+        && writeBlock(directories.constData(), qint64(directories.size()) * sizeof(LibraryIndex::StringRef))
+        && writeBlock(tracks.constData(), qint64(tracks.size()) * sizeof(LibraryIndex::TrackRecord))
+        && writeBlock(playlists.constData(), qint64(playlists.size()) * sizeof(LibraryIndex::PlaylistRecord))
+        && writeBlock(ids.constData(), qint64(ids.size()) * sizeof(quint32))
+        && writeBlock(strings.constData(), strings.size());
+    return ok && file.commit();
+}
+
+LibraryIndex::~LibraryIndex()
+{
+    close();
+}
+
+QString LibraryIndex::defaultPath()
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dir);
+    return dir + "/library.index";
+}
+
+bool LibraryIndex::write(const QString& filePath, const QVector<PlaylistSnapshot>& playlists,
+    const TrackCatalog& catalog, const QString& cachePath)
+{
+    const PathTable& table = PathTable::instance();
+    IndexBuilder builder;
+    QHash<PathId, quint32> trackIndexes;
+
+    for (const PlaylistSnapshot& snapshot : playlists) {
+        QVector<quint32> indexes;
+        indexes.reserve(snapshot.tracks.size());
+
+        for (PathId trackId : snapshot.tracks) {
+            auto it = trackIndexes.constFind(trackId);
+            if (it == trackIndexes.constEnd()) {
+                const TrackInfo& info = catalog.info(trackId);
+                TrackRecord track;
+                memset(&track, 0, sizeof(track));
+                track.directory = builder.addDirectory(table.directory(trackId));
+                track.name = builder.addString(table.fileName(trackId));
+                track.title = builder.addString(catalog.title(trackId));
+                track.reciter = builder.addString(catalog.reciter(trackId));
+                track.album = builder.addString(catalog.album(trackId));
+                track.durationMs = info.durationMs;
+                track.surahNumber = info.surahNumber;
+                track.flags = info.tagsRead ? TagsRead : 0;
+                track.playCount = info.playCount;
+                track.addedAt = info.addedAt;
+                track.fileSize = info.fileSize;
+                it = trackIndexes.insert(trackId, builder.addTrack(track));
+            }
+            indexes.append(it.value());
+        }
+        builder.addPlaylist(snapshot.name, snapshot.iconPath, snapshot.library, indexes);
+    }
+
+    return builder.save(filePath, cachePath);
+}
+
+bool LibraryIndex::open(const QString& filePath)
+{
+    close();
+    file.setFileName(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    quint64 size = quint64(file.size());
+    if (size < sizeof(Header)) {
+        close();
+        return false;
+    }
+    uchar* mapped = file.map(0, qint64(size));
+    if (mapped == nullptr) {
+        close();
+        return false;
+    }
+    data = mapped;
+
+    // كل ما يُقرأ لاحقاً يُقرأ بلا فحص، فالتحقق كله هنا (ملف تالف أو مقطوع = فهرس غير موجود)
+    const Header* h = reinterpret_cast<const Header*>(data);
+    auto fits = [size](quint64 offset, quint64 count, quint64 itemSize, quint64 alignment) {
+        return offset % alignment == 0 && offset <= size && count <= (size - offset) / itemSize;
+    };
+    bool valid = memcmp(h->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 && h->version == INDEX_VERSION
+        && fits(h->directoriesOffset, h->directoryCount, sizeof(StringRef), alignof(StringRef))
+        && fits(h->tracksOffset, h->trackCount, sizeof(TrackRecord), alignof(TrackRecord))
+        && fits(h->playlistsOffset, h->playlistCount, sizeof(PlaylistRecord), alignof(PlaylistRecord))
+        && fits(h->idsOffset, h->idCount, sizeof(quint32), alignof(quint32))
+        && fits(h->stringsOffset, h->stringsSize, 1, 1);
+    if (!valid) {
+        close();
+        return false;
+    }
+
+    header = h;
+    directories = reinterpret_cast<const StringRef*>(data + h->directoriesOffset);
+    tracks = reinterpret_cast<const TrackRecord*>(data + h->tracksOffset);
+    playlists = reinterpret_cast<const PlaylistRecord*>(data + h->playlistsOffset);
+    ids = reinterpret_cast<const quint32*>(data + h->idsOffset);
+    strings = reinterpret_cast<const char*>(data + h->stringsOffset);
+
+    auto validString = [h](const StringRef& ref) {
+        return ref.offset <= h->stringsSize && ref.length <= h->stringsSize - ref.offset;
+    };
+    for (quint32 i = 0; i < h->directoryCount && valid; ++i) {
+        valid = validString(directories[i]);
+    }
+    for (quint32 i = 0; i < h->trackCount && valid; ++i) {
+        const TrackRecord& track = tracks[i];
+        valid = track.directory < h->directoryCount && track.name.length > 0 && validString(track.name)
+            && validString(track.title) && validString(track.reciter) && validString(track.album);
+    }
+    for (quint32 i = 0; i < h->playlistCount && valid; ++i) {
+        const PlaylistRecord& list = playlists[i];
+        valid = validString(list.name) && validString(list.iconPath)
+            && list.firstTrack <= h->idCount && list.trackCount <= h->idCount - list.firstTrack;
+    }
+    for (quint32 i = 0; i < h->idCount && valid; ++i) {
+        valid = ids[i] < h->trackCount;
+    }
+    if (!valid) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void LibraryIndex::close()
+{
+    if (data != nullptr) file.unmap(const_cast<uchar*>(data));
+    file.close();
+    data = nullptr;
+    header = nullptr;
+    directories = nullptr;
+    tracks = nullptr;
+    playlists = nullptr;
+    ids = nullptr;
+    strings = nullptr;
+}
+
+bool LibraryIndex::matchesCache(const QString& cachePath) const
+{
+    if (header == nullptr) return false;
+    QFileInfo info(cachePath);
+    if (!info.exists()) return header->cacheSize < 0;
+    return info.size() == header->cacheSize && info.lastModified().toMSecsSinceEpoch() == header->cacheModified;
+}
+
+int LibraryIndex::directoryCount() const
+{
+    return header ? int(header->directoryCount) : 0;
+}
+
+QString LibraryIndex::directory(int index) const
+{
+    return text(directories[index]);
+}
+
+int LibraryIndex::trackCount() const
+{
+    return header ? int(header->trackCount) : 0;
+}
+
+int LibraryIndex::playlistCount() const
+{
+    return header ? int(header->playlistCount) : 0;
+}
+
+QByteArray LibraryIndex::bytes(const StringRef& ref) const
+{
+    return QByteArray::fromRawData(strings + ref.offset, int(ref.length));
+}
+
+QString LibraryIndex::text(const StringRef& ref) const
+{
+    return QString::fromUtf8(strings + ref.offset, int(ref.length));
+}
+
+void LibraryIndex::printStartupBenchmark(int trackCount)
+{
+    QTemporaryDir dir;
+    if (!dir.isValid()) return;
+    const QString cachePath = dir.filePath("library.cache");
+    const QString indexPath = dir.filePath("library.index");
+
+    // نفس المكتبة الوهمية في الصيغتين: 50 قارئاً، وسور مرقمة في مجلد كل قارئ
+    const QString root = "D:/QuranAudio";
+    const int reciterCount = 50;
+    LibraryCache cache;
+    IndexBuilder builder;
+    QVector<quint32> order;
+    LibraryCache::DirectoryRecord rootRecord;
+    rootRecord.modified = 1;
+
+    for (int reciter = 0; reciter < reciterCount; ++reciter) {
+        QString reciterName = QString("Reciter_%1").arg(reciter, 2, 10, QChar('0'));
+        QString reciterPath = root + "/" + reciterName;
+        rootRecord.subdirectories.append(reciterName);
+
+        LibraryCache::DirectoryRecord record;
+        record.modified = 1;
+        quint32 directoryId = builder.addDirectory(reciterPath + "/");
+
+        for (int i = reciter; i < trackCount; i += reciterCount) {
+            LibraryCache::FileRecord file;
+            file.name = QString("%1 - سورة %2.mp3").arg(i / reciterCount + 1, 3, 10, QChar('0')).arg(i % 114 + 1);
+            file.size = 4000000 + i;
+            file.modified = 1;
+            file.format = AudioFormat::Mp3;
+            file.durationMs = 300000 + i;
+            file.title = QString("سورة %1").arg(i % 114 + 1);
+            file.reciter = reciterName;
+            file.album = "المصحف المرتل";
+            file.surahNumber = qint16(i % 114 + 1);
+            file.tagsRead = true;
+            record.files.append(file);
+
+            TrackRecord track;
+            memset(&track, 0, sizeof(track));
+            track.directory = directoryId;
+            track.name = builder.addString(file.name);
+            track.title = builder.addString(file.title);
+            track.reciter = builder.addString(file.reciter);
+            track.album = builder.addString(file.album);
+            track.durationMs = file.durationMs;
+            track.surahNumber = file.surahNumber;
+            track.flags = TagsRead;
+            track.addedAt = 1;
+            track.fileSize = file.size;
+            order.append(builder.addTrack(track));
+        }
+        cache.setDirectory(reciterPath, record);
+    }
+    cache.setDirectory(root, rootRecord);
+    builder.addPlaylist("الافتراضية", QString(), true, order);
+    if (!cache.save(cachePath) || !builder.save(indexPath, cachePath)) return;
+
+    // الطريق القديم: فك QDataStream، ثم تقسيم كل مسار وتطبيعه، ثم فهرسة اسمه للبحث
+    QElapsedTimer elapsed;
+    elapsed.start();
+    {
+        LibraryCache loaded;
+        loaded.load(cachePath);
+        PathTable table;
+        SearchIndex search;
+        for (const LibraryCache::Track& track : loaded.tracks(root)) {
+            PathId pathId = table.intern(track.path);
+            search.setName(pathId, track.record.title);
+        }
+    }
+    double cacheMs = elapsed.nsecsElapsed() / 1e6;
+
+    // الفهرس: ربط الملف، ثم نسخ الأسماء كما هي وقراءة الوسوم من السجلات.
+    // توحيد المسارات وفهرس البحث يُقاسان وحدهما: يجريان في الخلفية بعد ظهور النافذة
+    auto restore = [&indexPath](double& mapMs, double& deferredMs) {
+        QElapsedTimer timer;
+        timer.start();
+        LibraryIndex index;
+        if (!index.open(indexPath)) return -1.0;
+        mapMs = timer.nsecsElapsed() / 1e6;
+
+        PathTable table;
+        table.reserve(index.trackCount());
+        QVector<quint32> directoryIds;
+        for (int i = 0; i < index.directoryCount(); ++i) {
+            directoryIds.append(table.restoreDirectory(index.directory(i)));
+        }
+        QHash<quint32, QString> tags;
+        QVector<PathId> pathIds;
+        pathIds.reserve(index.trackCount());
+        for (int i = 0; i < index.trackCount(); ++i) {
+            const TrackRecord& track = index.track(i);
+            QByteArray name = index.bytes(track.name);
+            pathIds.append(table.restoreFile(directoryIds[int(track.directory)], name.constData(), name.size()));
+            if (!tags.contains(track.title.offset)) tags.insert(track.title.offset, index.text(track.title));
+        }
+        double restoreMs = timer.nsecsElapsed() / 1e6;
+
+        QElapsedTimer deferred;
+        deferred.start();
+        TrackCatalog::RestoredIndexes indexes = TrackCatalog::buildRestoredIndexes(index, pathIds);
+        table.adoptCanonicalIndex(indexes.canonical);
+        deferredMs = deferred.nsecsElapsed() / 1e6;
+        return restoreMs;
+    };
+    double coldMapMs = 0, warmMapMs = 0, coldDeferredMs = 0, warmDeferredMs = 0;
+    double coldMs = restore(coldMapMs, coldDeferredMs);
+    double warmMs = restore(warmMapMs, warmDeferredMs);
+
+    qDebug() << "=== Startup benchmark ===";
+    qDebug() << "Tracks:" << trackCount << "| library.cache:" << QFileInfo(cachePath).size() / 1024 << "KiB"
+        << "| library.index:" << QFileInfo(indexPath).size() / 1024 << "KiB";
+    qDebug() << "library.cache (parse + intern + search index):" << QString::number(cacheMs, 'f', 1) << "ms";
+    qDebug() << "library.index first open:" << QString::number(coldMs, 'f', 1) << "ms (map + validate"
+        << QString::number(coldMapMs, 'f', 1) << "ms), then" << QString::number(coldDeferredMs, 'f', 1)
+        << "ms in the background (paths + search index), searchable after"
+        << QString::number(coldMs + coldDeferredMs, 'f', 1) << "ms";
+    qDebug() << "library.index second open:" << QString::number(warmMs, 'f', 1) << "ms (map + validate"
+        << QString::number(warmMapMs, 'f', 1) << "ms), then" << QString::number(warmDeferredMs, 'f', 1)
+        << "ms in the background (paths + search index), searchable after"
+        << QString::number(warmMs + warmDeferredMs, 'f', 1) << "ms";
+    qDebug() << "The files were just written, so the first open reads from the OS file cache;"
+        << "empty the cache (or reboot) and run again for disk-cold numbers.";
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QFile>
+#include "PathTable.h"
+
+class TrackCatalog;
+
+// --- فهرس المكتبة الثنائي (LibraryIndex) ---
+// ملف واحد يُفتح بـ QFile::map عند البدء، وسجلاته تُقرأ من الذاكرة المربوطة مباشرة بلا فك ترميز:
+//  - جدول نصوص UTF-8 (المجلدات، أسماء الملفات، الوسوم) وكل نص فيه مرة واحدة
+//  - سجل بحجم ثابت لكل سورة (TrackRecord)
+//  - لكل قائمة مصفوفة أرقام سور متتالية
+// أسماء الملفات تُنسخ كما هي لمخزن PathTable، وتطبيع المسارات وفهرس البحث يؤجلان لأول حاجة
+// (TrackCatalog::restore)، فمكتبة من 100 ألف سورة تظهر في عشرات الملي ثانية.
+// library.cache يبقى مصدر الفحص (أوقات المجلدات)، وهذا الملف يحفظ القوائم وبيانات الفهرس.
+// الأرقام بترتيب بايتات الجهاز (little-endian على Windows)، والملف لا يُنقل بين أجهزة.
+class LibraryIndex {
+public:
+    struct StringRef {
+        quint32 offset;
+        quint32 length;     // 0 = لا يوجد نص
+    };
+
+    enum TrackFlag {
+        TagsRead = 0x1
+    };
+
+    struct TrackRecord {
+        quint32 directory;  // رقم في جدول المجلدات
+        StringRef name;
+        StringRef title;
+        StringRef reciter;
+        StringRef album;
+        qint32 durationMs;
+        qint16 surahNumber;
+        quint8 flags;
+        quint8 reserved;
+        quint32 playCount;
+        qint64 addedAt;
+        qint64 fileSize;
+    };
+
+    enum PlaylistFlag {
+        LibraryPlaylist = 0x1   // القائمة التي يملؤها فحص المكتبة
+    };
+
+    struct PlaylistRecord {
+        StringRef name;
+        StringRef iconPath;
+        quint32 firstTrack;     // موضع أول رقم في مصفوفة الأرقام
+        quint32 trackCount;
+        quint32 flags;
+        quint32 reserved;
+    };
+
+    // قائمة كما هي في الذاكرة، للكتابة
+    struct PlaylistSnapshot {
+        QString name;
+        QString iconPath;
+        bool library = false;
+        QVector<PathId> tracks;     // أرقام TrackCatalog (canonicalId)
+    };
+
+    // ترويسة الملف: الأعداد ومواضع الأقسام (تعريفها في LibraryIndex.cpp)
+    struct Header;
+
+    LibraryIndex() = default;
+    ~LibraryIndex();
+
+    LibraryIndex(const LibraryIndex&) = delete;
+    LibraryIndex& operator=(const LibraryIndex&) = delete;
+
+    static QString defaultPath();
+
+    // يكتب السور التي تظهر في القوائم فقط، مع بصمة library.cache الحالي (حجمه ووقت تعديله)
+    static bool write(const QString& filePath, const QVector<PlaylistSnapshot>& playlists,
+        const TrackCatalog& catalog, const QString& cachePath);
+
+    // يربط الملف بالذاكرة ويتحقق من الترويسة وحدود كل الأقسام
+    bool open(const QString& filePath);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+
+    // الفهرس كُتب مع هذا الملف نفسه: غير ذلك يعني أن الفحص قد يفوته فرق، فيُتجاهل الفهرس
+    bool matchesCache(const QString& cachePath) const;
+
+    int directoryCount() const;
+    QString directory(int index) const;
+
+    int trackCount() const;
+    const TrackRecord& track(int index) const { return tracks[index]; }
+
+    int playlistCount() const;
+    const PlaylistRecord& playlist(int index) const { return playlists[index]; }
+    const quint32* playlistTracks(int index) const { return ids + playlists[index].firstTrack; }
+
+    // النص كما هو في الملف (بدون نسخ، صالح ما دام الملف مفتوحاً)
+    QByteArray bytes(const StringRef& ref) const;
+    QString text(const StringRef& ref) const;
+
+    // يقارن قراءة مكتبة وهمية من library.cache (QDataStream) ومن هذا الفهرس،
+    // أول مرة في العملية (صفحات الملف لم تُلمس بعد) ثم مرة ثانية، ويطبع النتيجة عبر qDebug
+    static void printStartupBenchmark(int trackCount = 100000);
+
+private:
+    QFile file;
+    const uchar* data = nullptr;
+    const Header* header = nullptr;
+    const StringRef* directories = nullptr;
+    const TrackRecord* tracks = nullptr;
+    const PlaylistRecord* playlists = nullptr;
+    const quint32* ids = nullptr;
+    const char* strings = nullptr;
+};
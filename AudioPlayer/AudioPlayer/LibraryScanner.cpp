@@ -0,0 +1,361 @@
+#include "LibraryScanner.h"
+#include "AudioFormat.h"
+#include <QDir>
+#include <QDateTime>
+#include <QSet>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QThread>
+
+// الدفعة الأولى صغيرة حتى تظهر أول سورة بسرعة، وبعدها دفعات أكبر لتقليل تحديثات العرض
+static const int FIRST_BATCH_SIZE = 64;
+static const int BATCH_SIZE = 2048;
+static const qint64 BATCH_INTERVAL_MS = 100;
+
+LibraryScanner::LibraryScanner(QObject* parent) : QObject(parent)
+{
+    // الخيوط تقضي أغلب وقتها في انتظار القرص، فعددها لا يرتبط بعدد الأنوية فقط
+    pool.setMaxThreadCount(qMax(8, QThread::idealThreadCount()));
+}
+
+LibraryScanner::~LibraryScanner()
+{
+    // الخيوط تستدعي دوال هذا الكائن، فلا يُحذف قبل توقفها
+    cancel();
+    pool.waitForDone();
+}
+
+void LibraryScanner::start(const QStringList& roots, const QSharedPointer<const LibraryCache>& previous, bool relistRoots)
+{
+    cancel();
+    if (roots.isEmpty()) return;
+
+    QSharedPointer<Scan> scan = prepare(roots, relistRoots);
+    scan->previous = previous;
+    launch(scan);
+}
+
+void LibraryScanner::start(const QStringList& roots, const QString& cacheFile)
+{
+    cancel();
+    if (roots.isEmpty()) return;
+
+    QSharedPointer<Scan> scan = prepare(roots, false);
+    pool.start([this, scan, cacheFile]() {
+        // فهرس غير موجود أو تالف = فحص كامل
+        QSharedPointer<LibraryCache> cache(new LibraryCache);
+        if (cache->load(cacheFile)) scan->previous = cache;
+        if (isCanceled(*scan)) return;
+        launch(scan);
+    });
+}
+
+QSharedPointer<LibraryScanner::Scan> LibraryScanner::prepare(const QStringList& roots, bool relistRoots)
+{
+    QSharedPointer<Scan> scan(new Scan);
+    scan->id = currentScan.loadAcquire();
+    scan->activeDirectories.storeRelease(roots.size());
+    scan->relistRoots = relistRoots;
+    for (const QString& root : roots) {
+        scan->roots.append(QDir::cleanPath(root));
+    }
+    scan->next.reset(new LibraryCache);
+    scan->batchLimit = FIRST_BATCH_SIZE;
+    scan->sinceLastBatch.start();
+
+    scanning = true;
+    lastStats = Stats();
+    elapsed.start();
+    return scan;
+}
+
+void LibraryScanner::launch(const QSharedPointer<Scan>& scan)
+{
+    // previous لا يتغير بعد هذه النقطة، فمهام المجلدات تقرؤه بلا قفل
+    for (const QString& path : scan->roots) {
+        pool.start([this, scan, path]() {
+            scanDirectory(scan, path, true);
+        });
+    }
+}
+
+void LibraryScanner::cancel()
+{
+    currentScan.fetchAndAddOrdered(1);
+    scanning = false;
+}
+
+void LibraryScanner::scanDirectory(const QSharedPointer<Scan>& scan, const QString& path, bool isRoot)
+{
+    // بعد الإلغاء لا أحد ينتظر نهاية الفحص، فلا حاجة لإنقاص activeDirectories
+    if (isCanceled(*scan)) return;
+
+    QFileInfo info(path);
+    if (isRoot && !info.isDir()) {
+        int scanId = scan->id;
+        QMetaObject::invokeMethod(this, [this, scanId, path]() {
+            reportMissing(scanId, path);
+        }, Qt::QueuedConnection);
+        finishDirectory(scan);
+        return;
+    }
+    scan->directories.ref();
+
+    qint64 modified = info.lastModified().toMSecsSinceEpoch();
+    const LibraryCache::DirectoryRecord* cached = scan->previous ? scan->previous->directory(path) : nullptr;
+
+    LibraryCache::DirectoryRecord record;
+    QStringList newFiles;
+    if (cached != nullptr && cached->modified == modified && !(isRoot && scan->relistRoots)) {
+        // لم يُضف فيه أو يُحذف أو يُعد تسمية شيء منذ الفحص السابق
+        record = *cached;
+        scan->reused.ref();
+        scanSubdirectories(scan, path, record.subdirectories);
+    }
+    else {
+        record.modified = modified;
+
+        // الترتيب بالاسم يبقي سور المجلد الواحد متتالية ومرتبة في القائمة
+        QFileInfoList entries = QDir(path).entryInfoList(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot | QDir::Readable, QDir::Name);
+        QFileInfoList files;
+        for (const QFileInfo& entry : entries) {
+            if (!entry.isDir()) files.append(entry);
+            // الروابط الرمزية قد تصنع حلقة لا تنتهي
+            else if (!entry.isSymLink()) record.subdirectories.append(entry.fileName());
+        }
+
+        // المجلدات الفرعية تبدأ قبل فتح ملفات هذا المجلد حتى تعمل الخيوط الأخرى
+        scanSubdirectories(scan, path, record.subdirectories);
+        record.files = readFiles(*scan, path, files, cached, newFiles);
+        if (isCanceled(*scan)) return;
+    }
+
+    {
+        QMutexLocker locker(&scan->mutex);
+        scan->next->setDirectory(path, record);
+    }
+
+    if (!newFiles.isEmpty()) addFiles(scan, newFiles);
+    finishDirectory(scan);
+}
+
+void LibraryScanner::scanSubdirectories(const QSharedPointer<Scan>& scan, const QString& path, const QStringList& names)
+{
+    for (const QString& name : names) {
+        QString subdirectory = LibraryCache::childPath(path, name);
+        scan->activeDirectories.ref();
+        pool.start([this, scan, subdirectory]() {
+            scanDirectory(scan, subdirectory, false);
+        });
+    }
+}
+
+QVector<LibraryCache::FileRecord> LibraryScanner::readFiles(Scan& scan, const QString& path, const QFileInfoList& entries,
+    const LibraryCache::DirectoryRecord* cached, QStringList& newFiles)
+{
+    QHash<QString, const LibraryCache::FileRecord*> known;
+    // ملفات صوت اختفت من المجلد، بالحجم ووقت التعديل: ملف جديد يطابقها هو نفسه باسم آخر
+    QMultiHash<QPair<qint64, qint64>, const LibraryCache::FileRecord*> vanished;
+    if (cached != nullptr) {
+        known.reserve(cached->files.size());
+        for (const LibraryCache::FileRecord& fileRecord : cached->files) {
+            known.insert(fileRecord.name, &fileRecord);
+        }
+
+        QSet<QString> present;
+        for (const QFileInfo& entry : entries) {
+            present.insert(entry.fileName());
+        }
+        for (const LibraryCache::FileRecord& fileRecord : cached->files) {
+            if (fileRecord.format != AudioFormat::Unknown && !present.contains(fileRecord.name)) {
+                vanished.insert(qMakePair(fileRecord.size, fileRecord.modified), &fileRecord);
+            }
+        }
+    }
+
+    QVector<LibraryCache::FileRecord> records;
+    records.reserve(entries.size());
+    QStringList changed;
+    QStringList renamedFrom;
+    QStringList renamedTo;
+
+    for (const QFileInfo& entry : entries) {
+        if (isCanceled(scan)) return records;
+
+        LibraryCache::FileRecord fileRecord;
+        fileRecord.name = entry.fileName();
+        fileRecord.size = entry.size();
+        fileRecord.modified = entry.lastModified().toMSecsSinceEpoch();
+
+        // نفس الحجم ووقت التعديل: الصيغة والبيانات المستخرجة كما هي، بدون فتح الملف
+        const LibraryCache::FileRecord* old = known.value(fileRecord.name, nullptr);
+        if (old != nullptr && old->size == fileRecord.size && old->modified == fileRecord.modified) {
+            records.append(*old);
+            continue;
+        }
+        // الملف تغير لكنه نفس السورة في المكتبة
+        if (old != nullptr) {
+            fileRecord.addedAt = old->addedAt;
+            fileRecord.playCount = old->playCount;
+        }
+
+        if (old == nullptr && !vanished.isEmpty()) {
+            auto match = vanished.find(qMakePair(fileRecord.size, fileRecord.modified));
+            if (match != vanished.end()) {
+                LibraryCache::FileRecord renamed = *match.value();
+                renamed.name = fileRecord.name;
+                records.append(renamed);
+                renamedFrom.append(LibraryCache::childPath(path, match.value()->name));
+                renamedTo.append(entry.absoluteFilePath());
+                vanished.erase(match);
+                continue;
+            }
+        }
+
+        scan.sniffed.ref();
+        fileRecord.format = AudioFormat::detect(entry.absoluteFilePath());
+        records.append(fileRecord);
+
+        if (fileRecord.format == AudioFormat::Unknown) {
+            scan.skipped.ref();
+        }
+        else if (old != nullptr && old->format != AudioFormat::Unknown) {
+            changed.append(entry.absoluteFilePath());
+        }
+        else {
+            newFiles.append(entry.absoluteFilePath());
+        }
+    }
+
+    if (!changed.isEmpty() || !renamedFrom.isEmpty()) {
+        QMutexLocker locker(&scan.mutex);
+        scan.changed += changed;
+        scan.renamedFrom += renamedFrom;
+        scan.renamedTo += renamedTo;
+    }
+    return records;
+}
+
+QStringList LibraryScanner::removedFiles(const Scan& scan, const QSet<QString>& renamed)
+{
+    QStringList removed;
+    const LibraryCache& previous = *scan.previous;
+    const LibraryCache& next = *scan.next;
+
+    for (const QString& path : previous.directoryPaths()) {
+        // الفحص الجزئي لا يعرف شيئاً عما خارج roots
+        bool scanned = false;
+        for (const QString& root : scan.roots) {
+            if (LibraryCache::isUnder(path, root)) {
+                scanned = true;
+                break;
+            }
+        }
+        if (!scanned) continue;
+
+        const LibraryCache::DirectoryRecord* before = previous.directory(path);
+        const LibraryCache::DirectoryRecord* after = next.directory(path);
+        // مجلد أُخذ من الفهرس كما هو: لا شيء حُذف منه
+        if (after != nullptr && after->modified == before->modified) continue;
+
+        QSet<QString> remaining;
+        if (after != nullptr) {
+            for (const LibraryCache::FileRecord& fileRecord : after->files) {
+                if (fileRecord.format != AudioFormat::Unknown) remaining.insert(fileRecord.name);
+            }
+        }
+        for (const LibraryCache::FileRecord& fileRecord : before->files) {
+            if (fileRecord.format == AudioFormat::Unknown || remaining.contains(fileRecord.name)) continue;
+            QString filePath = LibraryCache::childPath(path, fileRecord.name);
+            if (!renamed.contains(filePath)) removed.append(filePath);
+        }
+    }
+    return removed;
+}
+
+void LibraryScanner::addFiles(const QSharedPointer<Scan>& scan, const QStringList& files)
+{
+    QStringList ready;
+    {
+        QMutexLocker locker(&scan->mutex);
+        scan->batch += files;
+        if (scan->batch.size() < scan->batchLimit && scan->sinceLastBatch.elapsed() < BATCH_INTERVAL_MS) return;
+
+        ready.swap(scan->batch);
+        scan->batchLimit = BATCH_SIZE;
+        scan->sinceLastBatch.restart();
+    }
+
+    int scanId = scan->id;
+    QMetaObject::invokeMethod(this, [this, scanId, ready]() {
+        deliver(scanId, ready);
+    }, Qt::QueuedConnection);
+}
+
+void LibraryScanner::finishDirectory(const QSharedPointer<Scan>& scan)
+{
+    if (scan->activeDirectories.deref()) return;
+
+    // آخر مهمة: كل المهام الأخرى أرسلت دفعاتها قبل أن تنقص العداد
+    QStringList rest;
+    QStringList changed;
+    {
+        QMutexLocker locker(&scan->mutex);
+        rest.swap(scan->batch);
+        changed.swap(scan->changed);
+    }
+
+    QStringList removed;
+    QSharedPointer<LibraryCache> merged = scan->next;
+    if (scan->previous) {
+        QSet<QString> renamed;
+        for (const QString& path : scan->renamedFrom) {
+            renamed.insert(path);
+        }
+        removed = removedFiles(*scan, renamed);
+
+        merged.reset(new LibraryCache(*scan->previous));
+        merged->replaceUnder(scan->roots, *scan->next);
+    }
+
+    int scanId = scan->id;
+    QMetaObject::invokeMethod(this, [this, scanId, scan, merged, rest, changed, removed]() {
+        if (!rest.isEmpty()) deliver(scanId, rest);
+        complete(scanId, scan, merged, changed, removed);
+    }, Qt::QueuedConnection);
+}
+
+void LibraryScanner::deliver(int scanId, const QStringList& paths)
+{
+    // دفعة من فحص أُلغي ولم تصل إلا الآن
+    if (scanId != currentScan.loadAcquire()) return;
+
+    if (lastStats.firstBatchMs < 0) lastStats.firstBatchMs = elapsed.elapsed();
+    lastStats.fileCount += paths.size();
+    emit filesFound(paths);
+}
+
+void LibraryScanner::reportMissing(int scanId, const QString& root)
+{
+    if (scanId == currentScan.loadAcquire()) emit rootMissing(root);
+}
+
+void LibraryScanner::complete(int scanId, const QSharedPointer<Scan>& scan, const QSharedPointer<LibraryCache>& merged,
+    const QStringList& changed, const QStringList& removed)
+{
+    if (scanId != currentScan.loadAcquire()) return;
+
+    scanning = false;
+    lastStats.directoryCount = scan->directories.loadAcquire();
+    lastStats.skippedCount = scan->skipped.loadAcquire();
+    lastStats.reusedDirectories = scan->reused.loadAcquire();
+    lastStats.sniffedCount = scan->sniffed.loadAcquire();
+    lastStats.elapsedMs = elapsed.elapsed();
+    lastResult = merged;
+
+    // المحذوف أخيراً: الملف الذي أعيدت تسميته يجب أن يجد عقدته القديمة
+    if (!scan->renamedFrom.isEmpty()) emit filesRenamed(scan->renamedFrom, scan->renamedTo);
+    if (!changed.isEmpty()) emit filesChanged(changed);
+    if (!removed.isEmpty()) emit filesRemoved(removed);
+    emit finished();
+}
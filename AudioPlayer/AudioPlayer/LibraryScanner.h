@@ -0,0 +1,111 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QFileInfo>
+#include <QSet>
+#include "LibraryCache.h"
+
+// --- فحص المكتبة في الخلفية (LibraryScanner) ---
+// يمر على المجلدات وكل ما تحتها في خيوط QThreadPool خاص به (كل مجلد مهمة مستقلة)،
+// ويتعرف على ملفات الصوت من ترويستها (AudioFormat)، ثم يرسل الملفات المكتشفة للخيط
+// الرئيسي على دفعات (filesFound)، فتظهر النافذة فوراً وتمتلئ القائمة أثناء الفحص
+// مهما كان القرص بطيئاً (USB أو شبكة).
+// مع فهرس سابق (LibraryCache) يُقرأ وقت تعديل كل مجلد فقط، والمجلدات التي لم تتغير
+// لا يُقرأ محتواها ولا تُفتح ملفاتها، والإشارات تحمل الفرق عن الفهرس فقط.
+class LibraryScanner : public QObject {
+    Q_OBJECT
+public:
+    struct Stats {
+        int fileCount = 0;
+        int directoryCount = 0;
+        int skippedCount = 0;       // ملفات ليست صوتاً حسب ترويستها
+        int reusedDirectories = 0;  // مجلدات أُخذت من الفهرس بدون قراءة محتواها
+        int sniffedCount = 0;       // ملفات فُتحت لقراءة ترويستها
+        qint64 elapsedMs = 0;
+        qint64 firstBatchMs = -1;   // متى وصلت أول سورة للخيط الرئيسي (-1 = لم يُعثر على شيء)
+    };
+
+    explicit LibraryScanner(QObject* parent = nullptr);
+    ~LibraryScanner();
+
+    // يلغي أي فحص سابق ويبدأ فحص roots. previous (إن وجد) لا يُعدل أثناء الفحص.
+    // relistRoots: تُقرأ محتويات roots نفسها حتى لو لم يتغير وقت تعديلها
+    // (تنبيه من مراقب الملفات قد يعني تعديل ملف داخلها وليس إضافة أو حذف)
+    void start(const QStringList& roots, const QSharedPointer<const LibraryCache>& previous = QSharedPointer<const LibraryCache>(),
+        bool relistRoots = false);
+    // نفس الفحص، والفهرس السابق يُقرأ من cacheFile على خيط الفحص أولاً
+    // (القوائم ظهرت من LibraryIndex، فلا يُنتظر فك library.cache على الخيط الرئيسي)
+    void start(const QStringList& roots, const QString& cacheFile);
+    void cancel();
+    bool isScanning() const { return scanning; }
+    const Stats& stats() const { return lastStats; }
+
+    // الفهرس الجديد بعد finished: previous بعد استبدال ما تحت roots بنتيجة الفحص
+    QSharedPointer<LibraryCache> result() const { return lastResult; }
+
+signals:
+    // ملفات جديدة (غير موجودة في الفهرس السابق)
+    void filesFound(const QStringList& paths);
+    // ملفات موجودة تغير حجمها أو وقت تعديلها (بياناتها المستخرجة لم تعد صالحة)
+    void filesChanged(const QStringList& paths);
+    void filesRemoved(const QStringList& paths);
+    // ملف اختفى وظهر في نفس المجلد ملف جديد بنفس الحجم ووقت التعديل
+    void filesRenamed(const QStringList& oldPaths, const QStringList& newPaths);
+    void rootMissing(const QString& root);
+    void finished();
+
+private:
+    // حالة الفحص المشتركة بين مهام المجلدات
+    struct Scan {
+        int id = 0;
+        QAtomicInt activeDirectories;   // المهام التي لم تنته، وآخر مهمة تنهي الفحص
+        QAtomicInt directories;
+        QAtomicInt skipped;
+        QAtomicInt reused;
+        QAtomicInt sniffed;
+        QSharedPointer<const LibraryCache> previous;
+        QStringList roots;
+        bool relistRoots = false;
+
+        QMutex mutex;                   // يحمي ما تحته
+        QSharedPointer<LibraryCache> next;
+        QStringList changed;
+        QStringList renamedFrom;
+        QStringList renamedTo;
+        QStringList batch;
+        int batchLimit = 0;
+        QElapsedTimer sinceLastBatch;
+    };
+
+    QSharedPointer<Scan> prepare(const QStringList& roots, bool relistRoots);
+    void launch(const QSharedPointer<Scan>& scan);
+
+    // تعمل على خيوط pool، وكل ما تنتجه يُرسل للخيط الرئيسي عبر invokeMethod
+    void scanDirectory(const QSharedPointer<Scan>& scan, const QString& path, bool isRoot);
+    void scanSubdirectories(const QSharedPointer<Scan>& scan, const QString& path, const QStringList& names);
+    QVector<LibraryCache::FileRecord> readFiles(Scan& scan, const QString& path, const QFileInfoList& entries,
+        const LibraryCache::DirectoryRecord* cached, QStringList& newFiles);
+    void addFiles(const QSharedPointer<Scan>& scan, const QStringList& files);
+    static QStringList removedFiles(const Scan& scan, const QSet<QString>& renamed);
+    void finishDirectory(const QSharedPointer<Scan>& scan);
+    bool isCanceled(const Scan& scan) const { return currentScan.loadAcquire() != scan.id; }
+
+    // على الخيط الرئيسي
+    void deliver(int scanId, const QStringList& paths);
+    void reportMissing(int scanId, const QString& root);
+    void complete(int scanId, const QSharedPointer<Scan>& scan, const QSharedPointer<LibraryCache>& merged,
+        const QStringList& changed, const QStringList& removed);
+
+    QThreadPool pool;
+    QAtomicInt currentScan;   // المهام تتوقف عندما يتغير رقم الفحص
+    bool scanning = false;
+    QElapsedTimer elapsed;
+    Stats lastStats;
+    QSharedPointer<LibraryCache> lastResult;
+};
@@ -0,0 +1,143 @@
+#include "MetadataReader.h"
+#include "miniaudio.h"
+#include <QStringList>
+#include <QFileInfo>
+#include <QMetaObject>
+#include <QThread>
+#include <string>
+
+// مجموعة صغيرة حتى تصل أول النتائج بسرعة، وكبيرة بما يكفي لتقليل تحديثات العرض.
+// حساب المدة أبطأ بكثير من قراءة الوسم، فمجموعته أصغر
+static const int TAGS_PER_TASK = 32;
+static const int DURATIONS_PER_TASK = 8;
+
+// QThreadPool يبدأ المهام الأعلى أولوية أولاً
+static const int DURATION_PRIORITY = 0;
+static const int TAGS_PRIORITY = 1;
+static const int URGENT_PRIORITY = 2;
+
+MetadataReader::MetadataReader(QObject* parent) : QObject(parent)
+{
+    // قراءة الوسوم تنتظر القرص، وحساب المدد يشغل المعالج، فخيط لكل نواة على الأقل
+    pool.setMaxThreadCount(qMax(4, QThread::idealThreadCount()));
+}
+
+MetadataReader::~MetadataReader()
+{
+    cancel();
+    pool.waitForDone();
+}
+
+void MetadataReader::readTags(const QVector<PathId>& pathIds)
+{
+    start(Tags, pathIds);
+}
+
+void MetadataReader::readDurations(const QVector<PathId>& pathIds)
+{
+    start(Duration, pathIds);
+}
+
+void MetadataReader::readDurationNow(PathId pathId)
+{
+    // لا تُسجل في inFlight: إن كانت في الطابور أيضاً فالنتيجة الثانية تطابق الأولى
+    QStringList paths;
+    paths << PathTable::instance().path(pathId);
+    startTask(Duration, QVector<PathId>() << pathId, paths, URGENT_PRIORITY);
+}
+
+void MetadataReader::start(Kind kind, const QVector<PathId>& pathIds)
+{
+    // المسارات تُقرأ من PathTable هنا، فالخيوط لا تلمس الجداول المشتركة
+    const PathTable& table = PathTable::instance();
+    int perTask = kind == Tags ? TAGS_PER_TASK : DURATIONS_PER_TASK;
+    int priority = kind == Tags ? TAGS_PRIORITY : DURATION_PRIORITY;
+
+    QVector<PathId> ids;
+    QStringList paths;
+    for (PathId pathId : pathIds) {
+        if (inFlight[kind].contains(pathId)) {
+            stale[kind].insert(pathId);
+            continue;
+        }
+        inFlight[kind].insert(pathId);
+        ids.append(pathId);
+        paths.append(table.path(pathId));
+
+        if (ids.size() == perTask) {
+            startTask(kind, ids, paths, priority);
+            ids.clear();
+            paths.clear();
+        }
+    }
+    if (!ids.isEmpty()) startTask(kind, ids, paths, priority);
+}
+
+void MetadataReader::startTask(Kind kind, const QVector<PathId>& pathIds, const QStringList& paths, int priority)
+{
+    int generation = currentGeneration.loadAcquire();
+    pool.start([this, kind, generation, pathIds, paths]() {
+        QVector<Result> results;
+        results.reserve(pathIds.size());
+        for (int i = 0; i < pathIds.size(); ++i) {
+            if (currentGeneration.loadAcquire() != generation) return;
+            Result result;
+            result.pathId = pathIds[i];
+            if (kind == Tags) {
+                result.tags = AudioTags::read(paths[i]);
+                result.fileSize = QFileInfo(paths[i]).size();
+            }
+            else {
+                result.durationMs = measureDuration(paths[i]);
+            }
+            results.append(result);
+        }
+        QMetaObject::invokeMethod(this, [this, kind, generation, results]() {
+            deliver(kind, generation, results);
+        }, Qt::QueuedConnection);
+    }, priority);
+}
+
+qint32 MetadataReader::measureDuration(const QString& filePath)
+{
+    std::wstring wFilePath = filePath.toStdWString();
+    ma_decoder decoder;
+    if (::ma_decoder_init_file_w(wFilePath.c_str(), NULL, &decoder) != MA_SUCCESS) return -1;
+
+    qint32 durationMs = -1;
+    ma_uint64 frames = 0;
+    if (::ma_decoder_get_length_in_pcm_frames(&decoder, &frames) == MA_SUCCESS && frames > 0 && decoder.outputSampleRate > 0) {
+        durationMs = qint32(frames * 1000 / decoder.outputSampleRate);
+    }
+    ::ma_decoder_uninit(&decoder);
+    return durationMs;
+}
+
+void MetadataReader::cancel()
+{
+    currentGeneration.fetchAndAddOrdered(1);
+    for (int kind = 0; kind < KindCount; ++kind) {
+        inFlight[kind].clear();
+        stale[kind].clear();
+    }
+}
+
+void MetadataReader::deliver(Kind kind, int generation, const QVector<Result>& results)
+{
+    if (generation != currentGeneration.loadAcquire()) return;
+
+    QVector<Result> current;
+    QVector<PathId> again;
+    current.reserve(results.size());
+    for (const Result& result : results) {
+        inFlight[kind].remove(result.pathId);
+        if (stale[kind].remove(result.pathId)) again.append(result.pathId);
+        else current.append(result);
+    }
+
+    if (!current.isEmpty()) {
+        if (kind == Tags) emit tagsRead(current);
+        else emit durationsRead(current);
+    }
+    if (!again.isEmpty()) start(kind, again);
+}
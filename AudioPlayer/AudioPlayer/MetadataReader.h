@@ -0,0 +1,64 @@
+#pragma once
+#include <QObject>
+#include <QVector>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include "PathTable.h"
+#include "AudioTags.h"
+
+// --- قراءة البيانات في الخلفية (MetadataReader) ---
+// يقرأ وسوم السور (AudioTags) ومددها على خيوط QThreadPool خاص به، كل مهمة مجموعة صغيرة
+// من الملفات، ويرسل نتائج كل مجموعة للخيط الرئيسي (tagsRead / durationsRead) فتظهر
+// العناوين والمدد في القائمة تدريجياً بدون أن تتوقف الواجهة.
+// الوسوم تُقرأ قبل المدد: قراءة الوسم بضعة كيلوبايتات، وحساب مدة MP3 بمعدل بت متغير
+// يمر على إطارات الملف كله.
+class MetadataReader : public QObject {
+    Q_OBJECT
+public:
+    struct Result {
+        PathId pathId = INVALID_PATH_ID;
+        AudioTags tags;
+        qint64 fileSize = -1;       // مع الوسوم، للملفات التي لا يعرفها LibraryCache
+        qint32 durationMs = -1;     // -1 = تعذر فتح الملف أو حساب طوله
+    };
+
+    explicit MetadataReader(QObject* parent = nullptr);
+    ~MetadataReader();
+
+    // يضيف السور لطابور القراءة. سورة قيد القراءة الآن تُقرأ مرة أخرى بعد انتهائها
+    // (الملف تغير أثناء قراءته)، ونتيجتها القديمة تُهمل
+    void readTags(const QVector<PathId>& pathIds);
+    void readDurations(const QVector<PathId>& pathIds);
+    // مدة السورة التي بدأ تشغيلها قبل أن يصلها الطابور: قبل كل ما ينتظر
+    void readDurationNow(PathId pathId);
+
+    void cancel();
+    int pendingCount() const { return inFlight[Tags].size() + inFlight[Duration].size(); }
+
+    // على خيط العامل: طول الملف كما يراه ma_decoder عند التشغيل
+    static qint32 measureDuration(const QString& filePath);
+
+signals:
+    void tagsRead(const QVector<MetadataReader::Result>& results);
+    void durationsRead(const QVector<MetadataReader::Result>& results);
+
+private:
+    enum Kind {
+        Tags,
+        Duration,
+        KindCount
+    };
+
+    void start(Kind kind, const QVector<PathId>& pathIds);
+    void startTask(Kind kind, const QVector<PathId>& pathIds, const QStringList& paths, int priority);
+
+    // على الخيط الرئيسي
+    void deliver(Kind kind, int generation, const QVector<Result>& results);
+
+    QThreadPool pool;
+    QAtomicInt currentGeneration;   // المهام تتوقف عندما يتغير بعد cancel
+    QSet<PathId> inFlight[KindCount];
+    QSet<PathId> stale[KindCount];
+};
@@ -0,0 +1,238 @@
+#include "PathTable.h"
+#include "Playlist.h"
+#include <QtCore/qarraydata.h>
+#include <QDebug>
+#include <QDir>
+#include <cstring>
+
+PathTable& PathTable::instance()
+{
+    static PathTable table;
+    return table;
+}
+
+void PathTable::splitPath(const QString& absolutePath, QString& dir, QString& name)
+{
+    QString normalized = absolutePath;
+    normalized.replace('\\', '/');
+
+    int slash = normalized.lastIndexOf('/');
+    dir = normalized.left(slash + 1);
+    name = normalized.mid(slash + 1);
+}
+
+uint PathTable::entryKey(quint32 dirId, const QByteArray& name)
+{
+    return uint(qHash(name)) ^ (dirId * 0x9E3779B9u);
+}
+
+quint32 PathTable::internDirectory(const QString& dir)
+{
+    auto it = dirIndex.constFind(dir);
+    if (it != dirIndex.constEnd()) return it.value();
+
+    quint32 id = quint32(dirs.size());
+    dirs.append(dir);
+    dirIndex.insert(dir, id);
+    return id;
+}
+
+PathId PathTable::findEntry(quint32 dirId, const QByteArray& name, uint key) const
+{
+    for (auto it = fileIndex.constFind(key); it != fileIndex.constEnd() && it.key() == key; ++it) {
+        const Entry& entry = entries[int(it.value())];
+        if (entry.dirId == dirId && int(entry.nameLength) == name.size()
+            && memcmp(names.constData() + entry.nameOffset, name.constData(), name.size()) == 0) {
+            return it.value();
+        }
+    }
+    return INVALID_PATH_ID;
+}
+
+PathId PathTable::intern(const QString& absolutePath)
+{
+    QString dir, name;
+    splitPath(absolutePath, dir, name);
+
+    quint32 dirId = internDirectory(dir);
+    QByteArray utf8Name = name.toUtf8();
+    uint key = entryKey(dirId, utf8Name);
+
+    PathId existing = findEntry(dirId, utf8Name, key);
+    if (existing != INVALID_PATH_ID) return existing;
+
+    Entry entry;
+    entry.dirId = dirId;
+    entry.nameOffset = quint32(names.size());
+    entry.nameLength = quint32(utf8Name.size());
+    names.append(utf8Name);
+
+    PathId id = PathId(entries.size());
+    entries.append(entry);
+    fileIndex.insert(key, id);
+
+    // البحث عن مسار سابق يطابق هذا المسار بعد التطبيع
+    indexPendingCanonical();
+    QString normalized = normalizedPath(absolutePath);
+    uint normalizedKey = uint(qHash(normalized));
+    PathId canonical = id;
+    for (auto it = canonicalIndex.constFind(normalizedKey); it != canonicalIndex.constEnd() && it.key() == normalizedKey; ++it) {
+        if (normalizedPath(path(it.value())) == normalized) {
+            canonical = it.value();
+            break;
+        }
+    }
+    if (canonical == id) canonicalIndex.insert(normalizedKey, id);
+    canonicalIds.append(canonical);
+
+    return id;
+}
+
+void PathTable::reserve(int fileCount)
+{
+    entries.reserve(fileCount);
+    canonicalIds.reserve(fileCount);
+    fileIndex.reserve(fileCount);
+}
+
+quint32 PathTable::restoreDirectory(const QString& dir)
+{
+    return internDirectory(dir);
+}
+
+PathId PathTable::restoreFile(quint32 dirId, const char* utf8Name, int length)
+{
+    Entry entry;
+    entry.dirId = dirId;
+    entry.nameOffset = quint32(names.size());
+    entry.nameLength = quint32(length);
+    names.append(utf8Name, length);
+
+    PathId id = PathId(entries.size());
+    entries.append(entry);
+    fileIndex.insert(entryKey(dirId, QByteArray::fromRawData(utf8Name, length)), id);
+    canonicalIds.append(id);
+    pendingCanonical.append(id);
+    return id;
+}
+
+void PathTable::indexPendingCanonical()
+{
+    for (PathId id : pendingCanonical) {
+        canonicalIndex.insert(uint(qHash(normalizedPath(path(id)))), id);
+    }
+    pendingCanonical.clear();
+}
+
+void PathTable::adoptCanonicalIndex(QMultiHash<uint, PathId>& restored)
+{
+    // المستعادة تدخل جدولاً فارغاً، فما دامت معلقة لم يُضف لـ canonicalIndex شيء بعد
+    if (pendingCanonical.isEmpty() || !canonicalIndex.isEmpty() || restored.size() != pendingCanonical.size()) return;
+
+    canonicalIndex.swap(restored);
+    pendingCanonical.clear();
+}
+
+PathId PathTable::canonicalId(PathId id) const
+{
+    if (id >= PathId(canonicalIds.size())) return INVALID_PATH_ID;
+    return canonicalIds[int(id)];
+}
+
+QString PathTable::normalizedPath(const QString& absolutePath)
+{
+    QString normalized = QDir::cleanPath(QDir::fromNativeSeparators(absolutePath));
+#ifdef Q_OS_WIN
+    normalized = normalized.toCaseFolded();
+#endif
+    return normalized;
+}
+
+PathId PathTable::find(const QString& absolutePath) const
+{
+    QString dir, name;
+    splitPath(absolutePath, dir, name);
+
+    auto dirIt = dirIndex.constFind(dir);
+    if (dirIt == dirIndex.constEnd()) return INVALID_PATH_ID;
+
+    QByteArray utf8Name = name.toUtf8();
+    return findEntry(dirIt.value(), utf8Name, entryKey(dirIt.value(), utf8Name));
+}
+
+QString PathTable::path(PathId id) const
+{
+    if (id >= PathId(entries.size())) return QString();
+    return dirs[int(entries[int(id)].dirId)] + fileName(id);
+}
+
+QString PathTable::directory(PathId id) const
+{
+    if (id >= PathId(entries.size())) return QString();
+    return dirs[int(entries[int(id)].dirId)];
+}
+
+QString PathTable::fileName(PathId id) const
+{
+    if (id >= PathId(entries.size())) return QString();
+    const Entry& entry = entries[int(id)];
+    return QString::fromUtf8(names.constData() + entry.nameOffset, int(entry.nameLength));
+}
+
+qint64 PathTable::memoryUsage() const
+{
+    const qint64 stringHeader = sizeof(QArrayData);
+    // تقدير لحجم عقدة QHash (المفتاح + القيمة + مؤشر/بيانات داخلية)
+    const qint64 hashNodeOverhead = 2 * sizeof(void*);
+
+    qint64 total = sizeof(PathTable);
+    for (const QString& dir : dirs) {
+        // النص مخزن مرة واحدة ومشترك بين dirs و dirIndex (implicit sharing)
+        total += stringHeader + (dir.size() + 1) * sizeof(QChar);
+    }
+    total += dirs.capacity() * sizeof(QString);
+    total += dirIndex.size() * (sizeof(QString) + sizeof(quint32) + hashNodeOverhead);
+    total += entries.capacity() * sizeof(Entry);
+    total += names.capacity();
+    total += fileIndex.size() * (sizeof(uint) + sizeof(PathId) + hashNodeOverhead);
+    total += canonicalIds.capacity() * sizeof(PathId);
+    total += canonicalIndex.size() * (sizeof(uint) + sizeof(PathId) + hashNodeOverhead);
+    total += pendingCanonical.capacity() * sizeof(PathId);
+    return total;
+}
+
+void PathTable::printMemoryReport(int fileCount)
+{
+    const QString basePath = "D:/QuranAudio/";
+    const int reciterCount = 50;
+    const qint64 stringHeader = sizeof(QArrayData);
+
+    // التخزين القديم: QString name + QString path داخل كل عقدة
+    const qint64 oldNodeSize = qint64(sizeof(SurahNode)) - qint64(sizeof(PathId)) + 2 * qint64(sizeof(QString));
+    qint64 oldTotal = 0;
+
+    PathTable table;
+    for (int i = 0; i < fileCount; ++i) {
+        QString dir = basePath + QString("Reciter_%1/").arg(i % reciterCount, 2, 10, QChar('0'));
+        QString name = QString("%1 - سورة %2.mp3").arg(i / reciterCount + 1, 3, 10, QChar('0')).arg(i % 114 + 1);
+        QString path = dir + name;
+
+        oldTotal += oldNodeSize;
+        oldTotal += stringHeader + (name.size() + 1) * sizeof(QChar);
+        oldTotal += stringHeader + (path.size() + 1) * sizeof(QChar);
+
+        table.intern(path);
+    }
+
+    qint64 newTotal = qint64(sizeof(SurahNode)) * fileCount + table.memoryUsage();
+
+    qDebug() << "=== Path storage memory report ===";
+    qDebug() << "Tracks:" << fileCount << "in" << table.directoryCount() << "directories";
+    qDebug() << "Old layout (QString name + path per node):" << oldTotal / 1024 << "KiB"
+        << "(" << oldTotal / qMax(1, fileCount) << "bytes/track )";
+    qDebug() << "New layout (PathId per node + shared table):" << newTotal / 1024 << "KiB"
+        << "(" << newTotal / qMax(1, fileCount) << "bytes/track )";
+    if (newTotal > 0) {
+        qDebug() << "Reduction:" << QString::number(double(oldTotal) / double(newTotal), 'f', 2) << "x";
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QMultiHash>
+#include <QByteArray>
+
+typedef quint32 PathId;
+const PathId INVALID_PATH_ID = 0xFFFFFFFFu;
+
+// --- جدول المسارات المشترك (PathTable) ---
+// كل مسار يُخزن مرة واحدة فقط على شكل (رقم المجلد، اسم الملف):
+//  - المجلدات تُخزن مرة واحدة في dirs (مثلاً "D:/QuranAudio/" لآلاف الملفات)
+//  - أسماء الملفات تُخزن متتالية في مخزن UTF-8 واحد (names)
+// فيصبح كل مسار رقماً (PathId) ومقارنة مسارين مقارنة أعداد صحيحة.
+class PathTable {
+public:
+    static PathTable& instance();
+
+    // يعيد نفس الرقم لنفس المسار دائماً
+    PathId intern(const QString& absolutePath);
+    PathId find(const QString& absolutePath) const;
+
+    // استعادة سريعة من LibraryIndex لجدول فارغ: المسارات معروفة أنها فريدة وموحدة،
+    // فالاسم يُنسخ كما هو ويُؤجل تطبيعه لأول intern (مسار جديد قد يطابق أحدها)
+    void reserve(int fileCount);
+    quint32 restoreDirectory(const QString& dir);
+    PathId restoreFile(quint32 dirId, const char* utf8Name, int length);
+    // فهرس التوحيد للمسارات المستعادة محسوباً في الخلفية، يُهمل إن سبقه intern وفهرسها بنفسه
+    void adoptCanonicalIndex(QMultiHash<uint, PathId>& restored);
+
+    // رقم موحد لكل المسارات التي تشير لنفس الملف بعد التطبيع
+    // (الفواصل، "./" و "../"، وحالة الأحرف على ويندوز)
+    PathId canonicalId(PathId id) const;
+    static QString normalizedPath(const QString& absolutePath);
+
+    QString path(PathId id) const;
+    QString directory(PathId id) const;
+    QString fileName(PathId id) const;
+
+    int fileCount() const { return entries.size(); }
+    int directoryCount() const { return dirs.size(); }
+
+    // تقدير تقريبي لحجم الجدول في الذاكرة بالبايت
+    qint64 memoryUsage() const;
+
+    // يقارن بين التخزين القديم (QString للاسم والمسار في كل عقدة) والتخزين الجديد
+    // لمكتبة وهمية من fileCount ملف، ويطبع النتيجة عبر qDebug
+    static void printMemoryReport(int fileCount = 100000);
+
+private:
+    struct Entry {
+        quint32 dirId;
+        quint32 nameOffset;
+        quint32 nameLength;
+    };
+
+    quint32 internDirectory(const QString& dir);
+    PathId findEntry(quint32 dirId, const QByteArray& name, uint key) const;
+    static uint entryKey(quint32 dirId, const QByteArray& name);
+    static void splitPath(const QString& absolutePath, QString& dir, QString& name);
+    void indexPendingCanonical();
+
+    QVector<QString> dirs;
+    QHash<QString, quint32> dirIndex;
+    QVector<Entry> entries;
+    QByteArray names;
+    QMultiHash<uint, PathId> fileIndex;
+    QVector<PathId> canonicalIds;
+    QMultiHash<uint, PathId> canonicalIndex;
+    QVector<PathId> pendingCanonical;   // مستعادة ولم تدخل canonicalIndex بعد
+};
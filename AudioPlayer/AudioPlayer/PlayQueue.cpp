@@ -0,0 +1,91 @@
+#include "PlayQueue.h"
+#include <QSet>
+
+PlayQueue::PlayQueue(int initialCapacity)
+{
+    int capacity = 1;
+    while (capacity < initialCapacity) capacity <<= 1;
+    buffer.resize(capacity);
+}
+
+void PlayQueue::grow()
+{
+    QVector<QueuedTrack> larger(buffer.size() * 2);
+    for (int i = 0; i < length; ++i) {
+        larger[i] = buffer[physical(i)];
+    }
+    buffer.swap(larger);
+    start = 0;
+}
+
+void PlayQueue::enqueue(const QSharedPointer<Playlist>& list, SurahNode* node)
+{
+    if (node == nullptr) return;
+    if (length == buffer.size()) grow();
+
+    QueuedTrack& slot = buffer[physical(length)];
+    slot.playlist = list;
+    slot.node = node;
+    length++;
+}
+
+void PlayQueue::pushFront(const QSharedPointer<Playlist>& list, SurahNode* node)
+{
+    if (node == nullptr) return;
+    if (length == buffer.size()) grow();
+
+    start = (start - 1) & (buffer.size() - 1);
+    QueuedTrack& slot = buffer[start];
+    slot.playlist = list;
+    slot.node = node;
+    length++;
+}
+
+QueuedTrack PlayQueue::dequeue()
+{
+    if (length == 0) return QueuedTrack();
+
+    QueuedTrack track = buffer[start];
+    buffer[start] = QueuedTrack();
+    start = physical(1);
+    length--;
+    return track;
+}
+
+const QueuedTrack& PlayQueue::first() const
+{
+    static const QueuedTrack empty;
+    return length == 0 ? empty : buffer[start];
+}
+
+int PlayQueue::removeNodes(const QVector<SurahNode*>& nodes)
+{
+    if (length == 0 || nodes.isEmpty()) return 0;
+
+    QSet<SurahNode*> removed(nodes.begin(), nodes.end());
+
+    // ضغط العناصر الباقية في مكانها مع الحفاظ على ترتيبها
+    int kept = 0;
+    for (int i = 0; i < length; ++i) {
+        QueuedTrack& track = buffer[physical(i)];
+        if (removed.contains(track.node)) continue;
+        if (kept != i) buffer[physical(kept)] = track;
+        kept++;
+    }
+    for (int i = kept; i < length; ++i) {
+        buffer[physical(i)] = QueuedTrack();
+    }
+
+    int removedCount = length - kept;
+    length = kept;
+    return removedCount;
+}
+
+void PlayQueue::clear()
+{
+    for (int i = 0; i < length; ++i) {
+        buffer[physical(i)] = QueuedTrack();
+    }
+    start = 0;
+    length = 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <QVector>
+#include <QSharedPointer>
+#include "Playlist.h"
+
+// --- قائمة "التالي" (PlayQueue) ---
+// طابور دائري (ring buffer) لسور مختارة تُشغل قبل ترتيب القائمة الحالية.
+// كل عنصر يحفظ العقدة مع قائمتها، فيمكن أن يجمع الطابور سوراً من عدة قوائم،
+// والإضافة من الأمام أو الخلف والسحب من الأمام كلها O(1).
+struct QueuedTrack {
+    QSharedPointer<Playlist> playlist;
+    SurahNode* node = nullptr;
+};
+
+class PlayQueue {
+public:
+    explicit PlayQueue(int initialCapacity = 16);
+
+    // "إضافة للطابور": آخر ما يُشغل من الطابور
+    void enqueue(const QSharedPointer<Playlist>& list, SurahNode* node);
+    // "تشغيل تالياً": أول ما يُشغل
+    void pushFront(const QSharedPointer<Playlist>& list, SurahNode* node);
+
+    QueuedTrack dequeue();
+    const QueuedTrack& first() const;
+
+    bool isEmpty() const { return length == 0; }
+    int count() const { return length; }
+
+    // يحذف العقد التي حُذفت من قوائمها (O(count + nodes.size()))
+    int removeNodes(const QVector<SurahNode*>& nodes);
+    void clear();
+
+private:
+    int physical(int index) const { return (start + index) & (buffer.size() - 1); }
+    void grow();
+
+    QVector<QueuedTrack> buffer;   // السعة دائماً من قوى العدد 2
+    int start = 0;
+    int length = 0;
+};
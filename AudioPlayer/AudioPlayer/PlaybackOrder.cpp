@@ -0,0 +1,73 @@
+#include "PlaybackOrder.h"
+
+void PlaybackOrder::reset(const Playlist* playlist, SurahNode* current)
+{
+    clear();
+    list = playlist;
+    if (list == nullptr) return;
+
+    order.reserve(list->count());
+    positions.reserve(list->count());
+    for (SurahNode* node = list->head; node != nullptr; node = node->next) {
+        positions.insert(node, order.size());
+        order.append(node);
+    }
+    cursor = positions.value(current, -1);
+}
+
+void PlaybackOrder::clear()
+{
+    list = nullptr;
+    order.clear();
+    positions.clear();
+    cursor = -1;
+}
+
+SurahNode* PlaybackOrder::next()
+{
+    for (int i = cursor + 1; i < order.size(); ++i) {
+        if (order[i] != nullptr) {
+            cursor = i;
+            return order[i];
+        }
+    }
+    return nullptr;
+}
+
+SurahNode* PlaybackOrder::previous()
+{
+    for (int i = cursor - 1; i >= 0; --i) {
+        if (order[i] != nullptr) {
+            cursor = i;
+            return order[i];
+        }
+    }
+    return nullptr;
+}
+
+bool PlaybackOrder::jumpTo(SurahNode* node)
+{
+    int position = positions.value(node, -1);
+    if (position < 0) return false;
+
+    cursor = position;
+    return true;
+}
+
+void PlaybackOrder::onInserted(SurahNode* node)
+{
+    if (list == nullptr || positions.contains(node)) return;
+
+    positions.insert(node, order.size());
+    order.append(node);
+}
+
+void PlaybackOrder::onRemoved(SurahNode* node)
+{
+    int position = positions.value(node, -1);
+    if (position < 0) return;
+
+    // المؤشر يبقى في مكانه، فالتالي هو أول سورة باقية بعده
+    order[position] = nullptr;
+    positions.remove(node);
+}
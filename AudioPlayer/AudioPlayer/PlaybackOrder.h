@@ -0,0 +1,33 @@
+#pragma once
+#include <QVector>
+#include <QHash>
+#include "Playlist.h"
+
+// --- ترتيب التشغيل المتتابع (PlaybackOrder) ---
+// نسخة من ترتيب عقد القائمة تؤخذ عند بدء التشغيل منها، والتالي/السابق يمشيان عليها
+// وليس على روابط next/prev الحية، فالترتيب أو النقل أثناء التشغيل لا يغير ما يُشغل بعد الحالية.
+// التعديلات أثناء التشغيل تُطبق صراحة:
+//  - السورة المضافة تُلحق بآخر الترتيب (O(1))
+//  - السورة المحذوفة تُعلّم فارغة وتُتخطى (O(1))، فلا يبقى مؤشر لعقدة محررة
+// الترتيب الجديد للقائمة يُؤخذ عند بدء التشغيل التالي منها (clear ثم reset).
+class PlaybackOrder {
+public:
+    void reset(const Playlist* list, SurahNode* current);
+    void clear();
+    const Playlist* playlist() const { return list; }
+
+    SurahNode* next();
+    SurahNode* previous();
+
+    // يجعل العقدة هي الحالية، false = ليست في الترتيب
+    bool jumpTo(SurahNode* node);
+
+    void onInserted(SurahNode* node);
+    void onRemoved(SurahNode* node);
+
+private:
+    const Playlist* list = nullptr;
+    QVector<SurahNode*> order;          // nullptr = سورة حُذفت بعد أخذ النسخة
+    QHash<SurahNode*, int> positions;
+    int cursor = -1;
+};
@@ -0,0 +1,578 @@
+#include "Playlist.h"
+#include "TrackCatalog.h"
+#include <QRandomGenerator>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <new>
+#include <type_traits>
+
+QString SurahNode::name() const
+{
+    return TrackCatalog::instance().displayName(pathId);
+}
+
+QString SurahNode::path() const
+{
+    return PathTable::instance().path(pathId);
+}
+
+// ------------------------------------------------------------
+// SurahNodePool
+// ------------------------------------------------------------
+
+SurahNodePool::SurahNodePool(int chunkSize) : chunkSize(qMax(1, chunkSize))
+{
+}
+
+SurahNodePool::~SurahNodePool()
+{
+    releaseAll();
+}
+
+SurahNode* SurahNodePool::allocate()
+{
+    void* slot = nullptr;
+
+    if (freeList != nullptr) {
+        slot = freeList;
+        freeList = freeList->next;
+        counters.recycledNodes++;
+    }
+    else {
+        if (chunks.isEmpty() || usedInLastChunk == lastChunkCapacity) {
+            addChunk(chunkSize);
+        }
+        slot = chunks.last() + usedInLastChunk;
+        usedInLastChunk++;
+    }
+
+    counters.nodeAllocations++;
+    counters.liveNodes++;
+    return new (slot) SurahNode;
+}
+
+void SurahNodePool::addChunk(int capacity)
+{
+    chunks.append(static_cast<SurahNode*>(::operator new(sizeof(SurahNode) * capacity)));
+    usedInLastChunk = 0;
+    lastChunkCapacity = capacity;
+    counters.systemAllocations++;
+    counters.chunkCount = chunks.size();
+}
+
+void SurahNodePool::reserve(int count)
+{
+    int available = chunks.isEmpty() ? 0 : lastChunkCapacity - usedInLastChunk;
+    for (FreeSlot* slot = freeList; slot != nullptr && available < count; slot = slot->next) {
+        available++;
+    }
+
+    if (available < count) {
+        addChunk(qMax(chunkSize, count - available));
+    }
+}
+
+void SurahNodePool::release(SurahNode* node)
+{
+    if (node == nullptr) return;
+
+    node->~SurahNode();
+
+    FreeSlot* freeSlot = new (static_cast<void*>(node)) FreeSlot;
+    freeSlot->next = freeList;
+    freeList = freeSlot;
+    counters.liveNodes--;
+}
+
+void SurahNodePool::releaseAll()
+{
+    for (SurahNode* chunk : chunks) {
+        ::operator delete(chunk);
+    }
+    chunks.clear();
+    usedInLastChunk = 0;
+    lastChunkCapacity = 0;
+    freeList = nullptr;
+    counters.liveNodes = 0;
+    counters.chunkCount = 0;
+}
+
+// ------------------------------------------------------------
+// دوال مساعدة للشجرة الضمنية (Implicit Treap)
+// الترتيب داخل الشجرة هو ترتيب التشغيل، ومفتاح البحث هو حجم الشجرة الفرعية اليسرى
+// ------------------------------------------------------------
+
+static int subtreeSize(const SurahNode* node)
+{
+    return node ? node->size : 0;
+}
+
+static void update(SurahNode* node)
+{
+    node->size = 1 + subtreeSize(node->left) + subtreeSize(node->right);
+    if (node->left) node->left->parent = node;
+    if (node->right) node->right->parent = node;
+}
+
+// يقسم الشجرة إلى: أول count عقدة في left والباقي في right
+static void split(SurahNode* node, int count, SurahNode*& left, SurahNode*& right)
+{
+    if (node == nullptr) {
+        left = right = nullptr;
+        return;
+    }
+
+    if (subtreeSize(node->left) < count) {
+        split(node->right, count - subtreeSize(node->left) - 1, node->right, right);
+        left = node;
+    }
+    else {
+        split(node->left, count, left, node->left);
+        right = node;
+    }
+    update(node);
+}
+
+static SurahNode* merge(SurahNode* left, SurahNode* right)
+{
+    if (left == nullptr) return right;
+    if (right == nullptr) return left;
+
+    if (left->priority > right->priority) {
+        left->right = merge(left->right, right);
+        update(left);
+        return left;
+    }
+
+    right->left = merge(left, right->left);
+    update(right);
+    return right;
+}
+
+static void updateSubtree(SurahNode* node)
+{
+    if (node == nullptr) return;
+    updateSubtree(node->left);
+    updateSubtree(node->right);
+    update(node);
+}
+
+// يبني Treap من مصفوفة عقد بترتيبها في O(k) (بناء شجرة ديكارت باستخدام مكدس)
+static SurahNode* buildTreap(const QVector<SurahNode*>& nodes)
+{
+    QVector<SurahNode*> stack;
+    stack.reserve(64);
+
+    for (SurahNode* node : nodes) {
+        node->left = nullptr;
+        node->right = nullptr;
+        node->parent = nullptr;
+        node->size = 1;
+        node->priority = QRandomGenerator::global()->generate();
+
+        SurahNode* lastPopped = nullptr;
+        while (!stack.isEmpty() && stack.last()->priority < node->priority) {
+            lastPopped = stack.takeLast();
+        }
+        node->left = lastPopped;
+        if (!stack.isEmpty()) stack.last()->right = node;
+        stack.append(node);
+    }
+
+    SurahNode* root = stack.isEmpty() ? nullptr : stack.first();
+    updateSubtree(root);
+    return root;
+}
+
+static void setRoot(Playlist& list, SurahNode* root)
+{
+    list.root = root;
+    if (root) root->parent = nullptr;
+}
+
+// ------------------------------------------------------------
+
+int Playlist::count() const
+{
+    return subtreeSize(root);
+}
+
+SurahNode* Playlist::at(int row) const
+{
+    if (row < 0 || row >= count()) return nullptr;
+
+    SurahNode* current = root;
+    while (current != nullptr) {
+        int leftSize = subtreeSize(current->left);
+        if (row < leftSize) {
+            current = current->left;
+        }
+        else if (row == leftSize) {
+            return current;
+        }
+        else {
+            row -= leftSize + 1;
+            current = current->right;
+        }
+    }
+    return nullptr;
+}
+
+int Playlist::indexOf(const SurahNode* node) const
+{
+    if (node == nullptr) return -1;
+
+    int row = subtreeSize(node->left);
+    const SurahNode* current = node;
+    while (current->parent != nullptr) {
+        if (current == current->parent->right) {
+            row += subtreeSize(current->parent->left) + 1;
+        }
+        current = current->parent;
+    }
+
+    // العقدة ليست في هذه القائمة
+    if (current != root) return -1;
+    return row;
+}
+
+void Playlist::insertAt(int row, SurahNode* node)
+{
+    if (node == nullptr) return;
+    row = qBound(0, row, count());
+
+    node->left = nullptr;
+    node->right = nullptr;
+    node->parent = nullptr;
+    node->size = 1;
+    node->priority = QRandomGenerator::global()->generate();
+
+    // ربط القائمة المترابطة: العقدة تأتي بعد الصف row - 1
+    SurahNode* before = (row > 0) ? at(row - 1) : nullptr;
+    SurahNode* after = before ? before->next : head;
+
+    node->prev = before;
+    node->next = after;
+    if (before) before->next = node; else head = node;
+    if (after) after->prev = node; else tail = node;
+
+    SurahNode* leftPart = nullptr;
+    SurahNode* rightPart = nullptr;
+    split(root, row, leftPart, rightPart);
+    setRoot(*this, merge(merge(leftPart, node), rightPart));
+
+    pathIndex.insert(PathTable::instance().canonicalId(node->pathId), node);
+}
+
+void Playlist::append(SurahNode* node)
+{
+    insertAt(count(), node);
+}
+
+void Playlist::insertBatch(int row, const QVector<SurahNode*>& nodes)
+{
+    if (nodes.isEmpty()) return;
+    row = qBound(0, row, count());
+
+    SurahNode* before = (row > 0) ? at(row - 1) : nullptr;
+    SurahNode* after = before ? before->next : head;
+
+    SurahNode* previous = before;
+    for (SurahNode* node : nodes) {
+        node->prev = previous;
+        if (previous) previous->next = node; else head = node;
+        previous = node;
+
+        pathIndex.insert(PathTable::instance().canonicalId(node->pathId), node);
+    }
+    previous->next = after;
+    if (after) after->prev = previous; else tail = previous;
+
+    SurahNode* leftPart = nullptr;
+    SurahNode* rightPart = nullptr;
+    split(root, row, leftPart, rightPart);
+    setRoot(*this, merge(merge(leftPart, buildTreap(nodes)), rightPart));
+}
+
+void Playlist::appendBatch(const QVector<SurahNode*>& nodes)
+{
+    insertBatch(count(), nodes);
+}
+
+SurahNode* Playlist::removeAt(int row)
+{
+    if (row < 0 || row >= count()) return nullptr;
+
+    SurahNode* leftPart = nullptr;
+    SurahNode* middle = nullptr;
+    SurahNode* rightPart = nullptr;
+    split(root, row, leftPart, rightPart);
+    split(rightPart, 1, middle, rightPart);
+    setRoot(*this, merge(leftPart, rightPart));
+
+    SurahNode* node = middle;
+    pathIndex.remove(PathTable::instance().canonicalId(node->pathId), node);
+
+    if (node->prev) node->prev->next = node->next; else head = node->next;
+    if (node->next) node->next->prev = node->prev; else tail = node->prev;
+
+    node->next = nullptr;
+    node->prev = nullptr;
+    node->left = nullptr;
+    node->right = nullptr;
+    node->parent = nullptr;
+    node->size = 1;
+    return node;
+}
+
+QVector<SurahNode*> Playlist::removeRange(int row, int count)
+{
+    QVector<SurahNode*> removed;
+    if (row < 0 || row >= this->count() || count <= 0) return removed;
+    count = qMin(count, this->count() - row);
+
+    SurahNode* leftPart = nullptr;
+    SurahNode* middle = nullptr;
+    SurahNode* rightPart = nullptr;
+    split(root, row, leftPart, rightPart);
+    split(rightPart, count, middle, rightPart);
+    setRoot(*this, merge(leftPart, rightPart));
+
+    // العقد المحذوفة متتالية في القائمة المترابطة، وأولها هو أقصى يسار الجزء المقتطع
+    SurahNode* first = middle;
+    while (first->left != nullptr) first = first->left;
+
+    SurahNode* before = first->prev;
+    SurahNode* current = first;
+    removed.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        removed.append(current);
+        pathIndex.remove(PathTable::instance().canonicalId(current->pathId), current);
+        current = current->next;
+    }
+    SurahNode* after = current;
+
+    if (before) before->next = after; else head = after;
+    if (after) after->prev = before; else tail = before;
+
+    for (SurahNode* node : removed) {
+        node->next = nullptr;
+        node->prev = nullptr;
+        node->left = nullptr;
+        node->right = nullptr;
+        node->parent = nullptr;
+        node->size = 1;
+    }
+    return removed;
+}
+
+void Playlist::remove(SurahNode* node)
+{
+    removeAt(indexOf(node));
+}
+
+static SurahNode* leftmost(SurahNode* node)
+{
+    while (node != nullptr && node->left != nullptr) node = node->left;
+    return node;
+}
+
+static SurahNode* rightmost(SurahNode* node)
+{
+    while (node != nullptr && node->right != nullptr) node = node->right;
+    return node;
+}
+
+void Playlist::moveRange(int row, int count, int newRow)
+{
+    int total = this->count();
+    if (row < 0 || count <= 0 || row + count > total) return;
+    newRow = qBound(0, newRow, total - count);
+    if (newRow == row) return;
+
+    // 1. فصل المجال من الشجرة
+    SurahNode* leftPart = nullptr;
+    SurahNode* middle = nullptr;
+    SurahNode* rightPart = nullptr;
+    split(root, row, leftPart, rightPart);
+    split(rightPart, count, middle, rightPart);
+    SurahNode* rest = merge(leftPart, rightPart);
+    if (rest) rest->parent = nullptr;
+    middle->parent = nullptr;
+
+    // 2. فصله من القائمة المترابطة (أوله وآخره هما طرفا الجزء المقتطع)
+    SurahNode* first = leftmost(middle);
+    SurahNode* last = rightmost(middle);
+    if (first->prev) first->prev->next = last->next; else head = last->next;
+    if (last->next) last->next->prev = first->prev; else tail = first->prev;
+
+    // 3. إدراجه في موضعه الجديد من الباقي
+    split(rest, newRow, leftPart, rightPart);
+    SurahNode* before = rightmost(leftPart);
+    SurahNode* after = leftmost(rightPart);
+
+    first->prev = before;
+    last->next = after;
+    if (before) before->next = first; else head = first;
+    if (after) after->prev = last; else tail = last;
+
+    setRoot(*this, merge(merge(leftPart, middle), rightPart));
+}
+
+void Playlist::permute(const QVector<int>& oldRows)
+{
+    int total = count();
+    if (oldRows.size() != total || total == 0) return;
+
+    QVector<SurahNode*> current;
+    current.reserve(total);
+    for (SurahNode* node = head; node != nullptr; node = node->next) {
+        current.append(node);
+    }
+
+    QVector<SurahNode*> nodes;
+    nodes.reserve(total);
+    for (int row : oldRows) {
+        nodes.append(current[row]);
+    }
+
+    SurahNode* previous = nullptr;
+    for (SurahNode* node : nodes) {
+        node->prev = previous;
+        if (previous) previous->next = node; else head = node;
+        previous = node;
+    }
+    previous->next = nullptr;
+    tail = previous;
+
+    setRoot(*this, buildTreap(nodes));
+}
+
+bool Playlist::containsPath(PathId pathId) const
+{
+    return pathIndex.contains(PathTable::instance().canonicalId(pathId));
+}
+
+SurahNode* Playlist::findPath(PathId pathId) const
+{
+    return pathIndex.value(PathTable::instance().canonicalId(pathId), nullptr);
+}
+
+void Playlist::repath(SurahNode* node, PathId newPathId)
+{
+    const PathTable& table = PathTable::instance();
+    pathIndex.remove(table.canonicalId(node->pathId), node);
+    node->pathId = newPathId;
+    pathIndex.insert(table.canonicalId(newPathId), node);
+}
+
+void Playlist::detachAll()
+{
+    head = nullptr;
+    tail = nullptr;
+    root = nullptr;
+    pathIndex.clear();
+}
+
+SurahNode* Playlist::createNode()
+{
+    if (!pool) pool.reset(new SurahNodePool);
+    return pool->allocate();
+}
+
+void Playlist::destroyNode(SurahNode* node)
+{
+    if (node == nullptr || !pool) return;
+    pool->release(node);
+}
+
+void Playlist::reserveNodes(int count)
+{
+    if (!pool) pool.reset(new SurahNodePool);
+    pool->reserve(count);
+}
+
+void Playlist::clear()
+{
+    // العقدة لا تملك أي نصوص، لذلك لا حاجة للمرور عليها واحدة واحدة
+    // والذاكرة تُحرر كتلةً كتلة
+    static_assert(std::is_trivially_destructible<SurahNode>::value,
+        "SurahNode must stay trivially destructible: clear() frees whole chunks without destroying nodes");
+
+    if (pool) pool->releaseAll();
+    detachAll();
+}
+
+// ------------------------------------------------------------
+// تقرير المخصص (--memory-report)
+// ------------------------------------------------------------
+
+void SurahNodePool::printAllocationReport(int trackCount)
+{
+    const int reciterCount = 50;
+    PathTable& table = PathTable::instance();
+
+    QVector<PathId> pathIds;
+    pathIds.reserve(trackCount);
+    for (int i = 0; i < trackCount; ++i) {
+        pathIds.append(table.intern(QString("D:/QuranAudio/Reciter_%1/%2.mp3")
+            .arg(i % reciterCount, 2, 10, QChar('0')).arg(i / reciterCount + 1, 4, 10, QChar('0'))));
+    }
+
+    // 1. المخصص: حجز مسبق ثم إضافة دفعة واحدة كما في importPaths
+    QElapsedTimer timer;
+    timer.start();
+    Playlist list;
+    list.reserveNodes(trackCount);
+    QVector<SurahNode*> nodes;
+    nodes.reserve(trackCount);
+    for (PathId pathId : pathIds) {
+        SurahNode* node = list.createNode();
+        node->pathId = pathId;
+        nodes.append(node);
+    }
+    qint64 poolAllocMs = timer.elapsed();
+    list.appendBatch(nodes);
+
+    // حذف العُشر الأول وإعادته: الخانات المحررة تُستخدم بدل طلب كتل جديدة
+    int churn = trackCount / 10;
+    for (SurahNode* node : list.removeRange(0, churn)) {
+        list.destroyNode(node);
+    }
+    nodes.clear();
+    for (int i = 0; i < churn; ++i) {
+        SurahNode* node = list.createNode();
+        node->pathId = pathIds[i];
+        nodes.append(node);
+    }
+    list.appendBatch(nodes);
+    Stats stats = list.pool->stats();
+
+    timer.restart();
+    list.clear();
+    qint64 poolFreeMs = timer.elapsed();
+
+    // 2. الطريقة القديمة: new لكل عقدة و delete لكل عقدة
+    timer.restart();
+    QVector<SurahNode*> heapNodes;
+    heapNodes.reserve(trackCount);
+    for (PathId pathId : pathIds) {
+        SurahNode* node = new SurahNode;
+        node->pathId = pathId;
+        heapNodes.append(node);
+    }
+    qint64 heapAllocMs = timer.elapsed();
+
+    timer.restart();
+    qDeleteAll(heapNodes);
+    qint64 heapFreeMs = timer.elapsed();
+
+    qDebug() << "=== Node allocation report ===";
+    qDebug() << "Tracks:" << trackCount << "imported, then" << churn << "removed and re-added";
+    qDebug() << "Pool:" << stats.chunkCount << "chunks," << stats.systemAllocations << "system allocations,"
+        << stats.nodeAllocations << "nodes," << stats.recycledNodes << "recycled slots,"
+        << stats.liveNodes << "live";
+    qDebug() << "One new per node:" << trackCount + churn << "system allocations";
+    qDebug() << "Allocate:" << trackCount << "nodes: pool" << poolAllocMs << "ms, new per node" << heapAllocMs << "ms";
+    qDebug() << "Free: pool" << poolFreeMs << "ms, delete per node" << heapFreeMs << "ms";
+}
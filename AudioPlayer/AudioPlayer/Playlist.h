@@ -0,0 +1,142 @@
+#pragma once
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+#include <QMultiHash>
+#include "PathTable.h"
+
+// --- 1. تعريف العقدة (SurahNode) ---
+// كل عقدة مربوطة بطريقتين في نفس الوقت:
+//  - next / prev : القائمة المترابطة للتنقل التالي/السابق في O(1)
+//  - left / right / parent : شجرة Treap ضمنية (مرتبة بالموضع) للوصول بالرقم في O(log n)
+// الاسم والمسار لا يُخزنان في العقدة، بل رقم المسار في PathTable فقط
+// (وبيانات الملف المشتركة بين كل القوائم في TrackCatalog)
+struct SurahNode {
+    PathId pathId = INVALID_PATH_ID;
+    SurahNode* next = nullptr;
+    SurahNode* prev = nullptr;
+
+    SurahNode* left = nullptr;
+    SurahNode* right = nullptr;
+    SurahNode* parent = nullptr;
+    quint32 priority = 0;
+    int size = 1;   // عدد العقد في الشجرة الفرعية (بما فيها هذه العقدة)
+
+    QString name() const;
+    QString path() const;
+};
+
+// --- 2. مخصص العقد (SurahNodePool) ---
+// يحجز العقد على شكل كتل (slabs) بدل new لكل سورة، ويعيد استخدام الخانات المحذوفة
+// عبر قائمة حرة (free list)، ويحرر كل الكتل مرة واحدة عند حذف القائمة.
+class SurahNodePool {
+public:
+    struct Stats {
+        qint64 systemAllocations = 0;   // عدد مرات طلب ذاكرة من النظام (كتل)
+        qint64 nodeAllocations = 0;     // عدد العقد المحجوزة منذ البداية
+        qint64 recycledNodes = 0;       // عدد العقد التي أعيد استخدام خاناتها
+        int liveNodes = 0;
+        int chunkCount = 0;
+    };
+
+    explicit SurahNodePool(int chunkSize = 512);
+    ~SurahNodePool();
+
+    SurahNodePool(const SurahNodePool&) = delete;
+    SurahNodePool& operator=(const SurahNodePool&) = delete;
+
+    SurahNode* allocate();
+    void release(SurahNode* node);
+
+    // يضمن وجود count خانة فارغة على الأقل بطلب واحد من النظام (للإضافة الجماعية)
+    void reserve(int count);
+
+    // يحرر كل الكتل دفعة واحدة بدون استدعاء destructor لكل عقدة
+    void releaseAll();
+
+    const Stats& stats() const { return counters; }
+
+    // يستورد trackCount سورة وهمية بنفس طريقة الإضافة الجماعية ثم يحذف ويعيد عُشرها،
+    // ويطبع عدد الكتل وطلبات الذاكرة من النظام والخانات المعاد استخدامها
+    // مقارنة بـ new لكل عقدة (عبر qDebug)
+    static void printAllocationReport(int trackCount = 100000);
+
+private:
+    // الخانة المحررة تُستخدم نفسها كعنصر في القائمة الحرة
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    void addChunk(int capacity);
+
+    int chunkSize;
+    QVector<SurahNode*> chunks;
+    int usedInLastChunk = 0;
+    int lastChunkCapacity = 0;
+    FreeSlot* freeList = nullptr;
+    Stats counters;
+};
+
+typedef int PlaylistId;
+const PlaylistId INVALID_PLAYLIST_ID = -1;
+
+// --- 3. تعريف هيكل قائمة التشغيل (Playlist) ---
+struct Playlist {
+    PlaylistId id = INVALID_PLAYLIST_ID;   // يحدده PlaylistRegistry
+    QString name;
+    SurahNode* head = nullptr;
+    SurahNode* tail = nullptr;
+    QString iconPath;
+    SurahNode* root = nullptr;
+
+    int count() const;
+
+    // رقم الصف -> العقدة، والعكس (O(log n))
+    SurahNode* at(int row) const;
+    int indexOf(const SurahNode* node) const;
+
+    // الإدراج والحذف بالموضع مع الحفاظ على روابط next/prev (O(log n))
+    void insertAt(int row, SurahNode* node);
+    void append(SurahNode* node);
+
+    // يضيف مجموعة عقد متتالية دفعة واحدة: بناء الشجرة O(k) ثم تقسيم ودمج O(log n)
+    void insertBatch(int row, const QVector<SurahNode*>& nodes);
+    void appendBatch(const QVector<SurahNode*>& nodes);
+    SurahNode* removeAt(int row);
+
+    // يفصل count عقدة متتالية بدءاً من row في O(log n + count) ويعيدها بالترتيب
+    // (لا تُحرر العقد، ذلك مسؤولية المستدعي عبر destroyNode)
+    QVector<SurahNode*> removeRange(int row, int count);
+    void remove(SurahNode* node);
+
+    // ينقل count سورة متتالية من row بحيث تبدأ في الصف newRow بعد النقل
+    // (newRow من 0 إلى count() - count) في O(log n): العقد نفسها تُنقل بلا حجز أو تحرير
+    void moveRange(int row, int count, int newRow);
+
+    // يعيد ترتيب القائمة كلها: السورة في الصف الجديد i هي التي كانت في الصف oldRows[i]
+    // (إعادة ربط next/prev وبناء الشجرة مرة واحدة في O(n)، بدون حجز أو تحرير عقد)
+    void permute(const QVector<int>& oldRows);
+
+    // فحص التكرار عبر فهرس المسارات الموحدة (O(1))
+    bool containsPath(PathId pathId) const;
+    SurahNode* findPath(PathId pathId) const;
+
+    // يغير ملف العقدة في مكانها (إعادة تسمية الملف على القرص) ويحدث pathIndex
+    void repath(SurahNode* node, PathId newPathId);
+
+    // يفصل كل العقد عن القائمة بدون حذفها (الحذف مسؤولية المستدعي)
+    void detachAll();
+
+    // حجز وتحرير العقد من مخصص القائمة
+    SurahNode* createNode();
+    void destroyNode(SurahNode* node);
+    void reserveNodes(int count);
+
+    // يحذف كل العقد ويحرر ذاكرتها دفعة واحدة
+    void clear();
+
+    QSharedPointer<SurahNodePool> pool;
+
+    // canonicalId -> العقد، يُحدث تلقائياً مع كل إدراج وحذف
+    QMultiHash<PathId, SurahNode*> pathIndex;
+};
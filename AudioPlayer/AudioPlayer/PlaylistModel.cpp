@@ -0,0 +1,392 @@
+#include "PlaylistModel.h"
+#include "TrackCatalog.h"
+#include <QDataStream>
+#include <QIODevice>
+#include <algorithm>
+
+static const char* const ROWS_MIME_TYPE = "application/x-quranplaylist-rows";
+
+PlaylistModel::PlaylistModel(QObject* parent) : QAbstractListModel(parent)
+{
+}
+
+void PlaylistModel::setPlaylist(const QSharedPointer<Playlist>& newList)
+{
+    beginResetModel();
+    list = newList;
+    forgetCachedRow();
+    applyFilter();
+    endResetModel();
+}
+
+void PlaylistModel::setFilterText(const QString& text)
+{
+    QString query = SearchIndex::normalize(text);
+    if (query == filterQuery && filtering == !query.isEmpty()) return;
+
+    beginResetModel();
+    filterQuery = query;
+    filtering = !query.isEmpty();
+    applyFilter();
+    endResetModel();
+}
+
+void PlaylistModel::applyFilter()
+{
+    filtered.clear();
+    if (!filtering || !list) return;
+
+    const SearchIndex& index = TrackCatalog::instance().searchIndex();
+    QVector<PathId> trackIds;
+
+    // الفهرس مفيد فقط إن كانت نتائجه أقل من حجم القائمة، وإلا فالمرور على القائمة أسرع
+    if (index.find(filterQuery, trackIds) && trackIds.size() < list->count()) {
+        QVector<QPair<int, SurahNode*>> rows;
+        for (PathId trackId : trackIds) {
+            for (auto it = list->pathIndex.constFind(trackId); it != list->pathIndex.constEnd() && it.key() == trackId; ++it) {
+                rows.append(qMakePair(list->indexOf(it.value()), it.value()));
+            }
+        }
+        std::sort(rows.begin(), rows.end());
+
+        filtered.reserve(rows.size());
+        for (const QPair<int, SurahNode*>& row : rows) {
+            filtered.append(row.second);
+        }
+        return;
+    }
+
+    const TrackCatalog& catalog = TrackCatalog::instance();
+    for (SurahNode* node = list->head; node != nullptr; node = node->next) {
+        if (index.matches(catalog.trackOf(node->pathId), filterQuery)) filtered.append(node);
+    }
+}
+
+int PlaylistModel::listRow(int viewRow) const
+{
+    if (!filtering) return viewRow;
+    if (!list || viewRow < 0 || viewRow >= filtered.size()) return -1;
+    return list->indexOf(filtered[viewRow]);
+}
+
+int PlaylistModel::viewRow(int listRow) const
+{
+    if (!filtering) return listRow;
+    if (!list) return -1;
+
+    int position = filteredPosition(listRow);
+    if (position < filtered.size() && list->indexOf(filtered[position]) == listRow) return position;
+    return -1;
+}
+
+int PlaylistModel::filteredPosition(int listRow) const
+{
+    // filtered مرتبة بترتيب القائمة، فالبحث ثنائي
+    int low = 0;
+    int high = filtered.size();
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (list->indexOf(filtered[middle]) < listRow) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
+
+void PlaylistModel::refilterTrack(PathId trackId)
+{
+    if (!filtering || !list || batchDepth > 0) return;
+
+    bool match = TrackCatalog::instance().searchIndex().matches(trackId, filterQuery);
+    for (auto it = list->pathIndex.constFind(trackId); it != list->pathIndex.constEnd() && it.key() == trackId; ++it) {
+        SurahNode* node = it.value();
+        int position = filteredPosition(list->indexOf(node));
+        bool shown = position < filtered.size() && filtered[position] == node;
+
+        if (match && !shown) {
+            beginInsertRows(QModelIndex(), position, position);
+            filtered.insert(position, node);
+            endInsertRows();
+        }
+        else if (!match && shown) {
+            beginRemoveRows(QModelIndex(), position, position);
+            filtered.remove(position);
+            endRemoveRows();
+        }
+    }
+}
+
+QString PlaylistModel::toolTip(const SurahNode* node)
+{
+    // القارئ والألبوم من الوسوم (إن قُرئت) فوق مسار الملف
+    const TrackCatalog& catalog = TrackCatalog::instance();
+    QStringList lines;
+    QString reciter = catalog.reciter(node->pathId);
+    QString album = catalog.album(node->pathId);
+    if (!reciter.isEmpty()) lines << "القارئ: " + reciter;
+    if (!album.isEmpty()) lines << "الألبوم: " + album;
+    lines << node->path();
+    return lines.join('\n');
+}
+
+QString PlaylistModel::formatDuration(qint32 durationMs)
+{
+    if (durationMs < 0) return QString();
+    int seconds = durationMs / 1000;
+    QString text = QString("%1:%2").arg((seconds / 60) % 60).arg(seconds % 60, 2, 10, QChar('0'));
+    if (seconds >= 3600) text = QString("%1:%2").arg(seconds / 3600).arg(text.rightJustified(5, '0'));
+    return text;
+}
+
+void PlaylistModel::forgetCachedRow() const
+{
+    cachedRow = -1;
+    cachedNode = nullptr;
+}
+
+SurahNode* PlaylistModel::nodeAt(int row) const
+{
+    if (filtering) return filtered.value(row, nullptr);
+    if (!list || row < 0 || row >= list->count()) return nullptr;
+
+    SurahNode* node = nullptr;
+    if (cachedNode != nullptr && row == cachedRow) node = cachedNode;
+    else if (cachedNode != nullptr && row == cachedRow + 1) node = cachedNode->next;
+    else if (cachedNode != nullptr && row == cachedRow - 1) node = cachedNode->prev;
+    else node = list->at(row);
+
+    cachedRow = row;
+    cachedNode = node;
+    return node;
+}
+
+int PlaylistModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid() || !list) return 0;
+    return filtering ? filtered.size() : list->count();
+}
+
+QVariant PlaylistModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) return QVariant();
+
+    SurahNode* node = nodeAt(index.row());
+    if (node == nullptr) return QVariant();
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return node->name();
+    case Qt::ToolTipRole:
+        return toolTip(node);
+    case PathIdRole:
+        return node->pathId;
+    case RowNumberRole:
+        return (filtering ? list->indexOf(node) : index.row()) + 1;
+    case DurationRole:
+        return formatDuration(TrackCatalog::instance().info(node->pathId).durationMs);
+    default:
+        return QVariant();
+    }
+}
+
+Qt::ItemFlags PlaylistModel::flags(const QModelIndex& index) const
+{
+    Qt::ItemFlags defaultFlags = QAbstractListModel::flags(index);
+    // الإفلات بين الصفوف فقط، وليس فوقها
+    if (!index.isValid()) return filtering ? defaultFlags : defaultFlags | Qt::ItemIsDropEnabled;
+    // النقل داخل نتائج البحث غير واضح المعنى، فالسحب متاح للقائمة كاملة فقط
+    return filtering ? defaultFlags : defaultFlags | Qt::ItemIsDragEnabled;
+}
+
+Qt::DropActions PlaylistModel::supportedDropActions() const
+{
+    return Qt::MoveAction;
+}
+
+QStringList PlaylistModel::mimeTypes() const
+{
+    return QStringList() << ROWS_MIME_TYPE;
+}
+
+QMimeData* PlaylistModel::mimeData(const QModelIndexList& indexes) const
+{
+    QByteArray encoded;
+    QDataStream stream(&encoded, QIODevice::WriteOnly);
+    for (const QModelIndex& index : indexes) {
+        if (index.isValid()) stream << qint32(index.row());
+    }
+
+    QMimeData* data = new QMimeData;
+    data->setData(ROWS_MIME_TYPE, encoded);
+    return data;
+}
+
+bool PlaylistModel::dropMimeData(const QMimeData* data, Qt::DropAction action, int row, int column, const QModelIndex& parent)
+{
+    Q_UNUSED(column);
+    if (!list || action != Qt::MoveAction || !data->hasFormat(ROWS_MIME_TYPE)) return false;
+
+    QByteArray encoded = data->data(ROWS_MIME_TYPE);
+    QDataStream stream(&encoded, QIODevice::ReadOnly);
+    QList<int> rows;
+    while (!stream.atEnd()) {
+        qint32 dragged;
+        stream >> dragged;
+        if (dragged >= 0 && dragged < list->count()) rows.append(dragged);
+    }
+    if (rows.isEmpty()) return false;
+
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    int targetRow = row;
+    if (targetRow < 0) targetRow = parent.isValid() ? parent.row() : list->count();
+    emit tracksDropped(rows, targetRow);
+
+    // false: العرض لا يحذف الصفوف المسحوبة، فالنقل تم بالفعل
+    return false;
+}
+
+// أثناء البحث تُفحص السور المضافة فقط، والحذف والنقل يُترجمان لمواضعها في filtered
+// (إعادة الترتيب الكامل وحدها تعيد حساب النتائج)
+void PlaylistModel::beginInsertTracks(int row, int count)
+{
+    forgetCachedRow();
+    if (batchDepth > 0) return;
+    if (filtering) {
+        // العقد لم تدخل القائمة بعد، فالفحص في endInsertTracks
+        pendingFirst = row;
+        pendingLast = row + count;
+        return;
+    }
+    beginInsertRows(QModelIndex(), row, row + count - 1);
+}
+
+void PlaylistModel::endInsertTracks()
+{
+    if (batchDepth > 0) return;
+    if (!filtering) {
+        endInsertRows();
+        return;
+    }
+
+    const SearchIndex& index = TrackCatalog::instance().searchIndex();
+    const TrackCatalog& catalog = TrackCatalog::instance();
+    QVector<SurahNode*> matched;
+    SurahNode* node = list->at(pendingFirst);
+    for (int row = pendingFirst; row < pendingLast && node != nullptr; ++row, node = node->next) {
+        if (index.matches(catalog.trackOf(node->pathId), filterQuery)) matched.append(node);
+    }
+    if (matched.isEmpty()) return;
+
+    // السور المضافة متتالية في القائمة، فالمطابق منها يدخل النتائج في موضع واحد
+    int position = filteredPosition(pendingFirst);
+    beginInsertRows(QModelIndex(), position, position + matched.size() - 1);
+    filtered.insert(position, matched.size(), nullptr);
+    std::copy(matched.constBegin(), matched.constEnd(), filtered.begin() + position);
+    endInsertRows();
+}
+
+void PlaylistModel::beginRemoveTracks(int row, int count)
+{
+    forgetCachedRow();
+    if (batchDepth > 0) return;
+    if (filtering) {
+        pendingFirst = filteredPosition(row);
+        pendingLast = filteredPosition(row + count);
+        if (pendingLast > pendingFirst) beginRemoveRows(QModelIndex(), pendingFirst, pendingLast - 1);
+        return;
+    }
+    beginRemoveRows(QModelIndex(), row, row + count - 1);
+}
+
+void PlaylistModel::endRemoveTracks()
+{
+    forgetCachedRow();
+    if (batchDepth > 0) return;
+    if (!filtering) {
+        endRemoveRows();
+        return;
+    }
+    if (pendingLast > pendingFirst) {
+        filtered.remove(pendingFirst, pendingLast - pendingFirst);
+        endRemoveRows();
+    }
+}
+
+void PlaylistModel::beginReorder()
+{
+    forgetCachedRow();
+    if (batchDepth > 0) return;
+    beginResetModel();
+}
+
+void PlaylistModel::endReorder()
+{
+    forgetCachedRow();
+    if (batchDepth > 0) return;
+    applyFilter();
+    endResetModel();
+}
+
+bool PlaylistModel::beginMoveTracks(int row, int count, int newRow)
+{
+    forgetCachedRow();
+    if (batchDepth > 0) return true;
+
+    // Qt يريد موضع الإدراج قبل النقل، وnewRow موضع البداية بعده
+    int destination = (newRow > row) ? newRow + count : newRow;
+    if (!filtering) return beginMoveRows(QModelIndex(), row, row + count - 1, QModelIndex(), destination);
+
+    // نتائج المجال متتالية في filtered، وتنتقل قبل أول نتيجة بعد موضع الإدراج
+    pendingFirst = filteredPosition(row);
+    pendingLast = filteredPosition(row + count);
+    pendingDestination = filteredPosition(destination);
+    if (pendingLast == pendingFirst || (pendingDestination >= pendingFirst && pendingDestination <= pendingLast)) {
+        // لا نتائج في المجال، أو لا نتيجة بين موضعيه القديم والجديد: ترتيب النتائج لا يتغير
+        pendingDestination = -1;
+        return true;
+    }
+    beginMoveRows(QModelIndex(), pendingFirst, pendingLast - 1, QModelIndex(), pendingDestination);
+    return true;
+}
+
+void PlaylistModel::endMoveTracks()
+{
+    forgetCachedRow();
+    if (batchDepth > 0) return;
+    if (!filtering) {
+        endMoveRows();
+        return;
+    }
+    if (pendingDestination < 0) return;
+
+    int moved = pendingLast - pendingFirst;
+    QVector<SurahNode*> block = filtered.mid(pendingFirst, moved);
+    filtered.remove(pendingFirst, moved);
+    int position = (pendingDestination > pendingFirst) ? pendingDestination - moved : pendingDestination;
+    filtered.insert(position, moved, nullptr);
+    std::copy(block.constBegin(), block.constEnd(), filtered.begin() + position);
+    endMoveRows();
+}
+
+void PlaylistModel::beginBatch()
+{
+    // بدون بحث كل حذف يرسل صفوفه بنفسه (من الأسفل للأعلى)، فلا داعي لإعادة الضبط
+    if (!filtering) return;
+    if (batchDepth++ == 0) beginResetModel();
+}
+
+void PlaylistModel::endBatch()
+{
+    if (batchDepth == 0 || --batchDepth > 0) return;
+    forgetCachedRow();
+    applyFilter();
+    endResetModel();
+}
+
+void PlaylistModel::refreshRow(int listRow)
+{
+    if (batchDepth > 0) return;
+    QModelIndex changed = index(viewRow(listRow));
+    if (changed.isValid()) emit dataChanged(changed, changed);
+}
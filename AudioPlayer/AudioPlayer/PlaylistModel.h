@@ -0,0 +1,93 @@
+#pragma once
+#include <QAbstractListModel>
+#include <QSharedPointer>
+#include <QMimeData>
+#include <QStringList>
+#include "Playlist.h"
+
+// --- نموذج عرض القائمة (PlaylistModel) ---
+// العرض يقرأ الصفوف الظاهرة فقط من القائمة نفسها عند الرسم، فلا توجد نسخة
+// من الأسماء في عناصر الواجهة، وتبديل القائمة المعروضة O(1) (إعادة ضبط النموذج).
+// تعديل القائمة المعروضة يجب أن يحاط بدوال begin/end المناسبة حتى يحدّث العرض نفسه.
+// أثناء البحث يعرض النموذج السور المطابقة فقط، وأرقام الصفوف في العرض تختلف عن أرقامها
+// في القائمة: listRow / viewRow للتحويل بينهما.
+class PlaylistModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    enum Roles {
+        PathIdRole = Qt::UserRole + 1,
+        RowNumberRole,              // رقم السورة في القائمة كاملة (يبدأ من 1)
+        DurationRole                // "m:ss" أو نص فارغ إن لم تُعرف المدة بعد
+    };
+
+    explicit PlaylistModel(QObject* parent = nullptr);
+
+    void setPlaylist(const QSharedPointer<Playlist>& list);
+    Playlist* playlist() const { return list.data(); }
+
+    // رقم الصف في العرض -> العقدة، مع تذكر آخر صف مطلوب لأن العرض يقرأ الصفوف بالتتابع
+    SurahNode* nodeAt(int row) const;
+
+    // عرض السور التي يحتوي اسمها على النص فقط (نص فارغ = كل القائمة)
+    void setFilterText(const QString& text);
+    bool isFiltered() const { return filtering; }
+    int listRow(int viewRow) const;
+    int viewRow(int listRow) const;
+    // تغير اسم السورة (canonicalId) أثناء البحث: تظهر أو تختفي صفوفها حسب النص الحالي
+    void refilterTrack(PathId trackId);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    // السحب والإفلات داخل القائمة: النموذج لا ينقل شيئاً بنفسه،
+    // بل يرسل tracksDropped ليتم النقل (وتسجيله للتراجع) في مكان واحد
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+    Qt::DropActions supportedDropActions() const override;
+    QStringList mimeTypes() const override;
+    QMimeData* mimeData(const QModelIndexList& indexes) const override;
+    bool dropMimeData(const QMimeData* data, Qt::DropAction action, int row, int column, const QModelIndex& parent) override;
+
+    void beginInsertTracks(int row, int count);
+    void endInsertTracks();
+    void beginRemoveTracks(int row, int count);
+    void endRemoveTracks();
+    void beginReorder();
+    void endReorder();
+    // نفس معنى Playlist::moveRange
+    bool beginMoveTracks(int row, int count, int newRow);
+    void endMoveTracks();
+
+    // عدة تعديلات متتالية (حذف مجالات متفرقة مثلاً) أثناء البحث تظهر في العرض كتحديث واحد:
+    // دوال begin/end بينهما لا ترسل شيئاً، وendBatch يعيد ضبط النموذج مرة واحدة.
+    // بدون بحث لا يفعلان شيئاً وكل تعديل يرسل إشارات صفوفه
+    void beginBatch();
+    void endBatch();
+
+    // إعادة رسم سورة واحدة برقمها في القائمة (تغير اسمها مثلاً)
+    void refreshRow(int listRow);
+
+signals:
+    // rows مرتبة تصاعدياً، وtargetRow هو الصف الذي أُفلتت قبله (count() = آخر القائمة)
+    void tracksDropped(const QList<int>& rows, int targetRow);
+
+private:
+    void forgetCachedRow() const;
+    void applyFilter();
+    // أول موضع في filtered لسورة رقمها في القائمة listRow أو بعده
+    int filteredPosition(int listRow) const;
+    static QString toolTip(const SurahNode* node);
+    static QString formatDuration(qint32 durationMs);
+
+    QSharedPointer<Playlist> list;
+    bool filtering = false;
+    QString filterQuery;                // بعد التطبيع
+    QVector<SurahNode*> filtered;       // السور المطابقة بترتيب القائمة
+    int batchDepth = 0;
+    // تعديل جارٍ أثناء البحث (بين begin و end): مجاله في filtered (أو في القائمة عند الإدراج)
+    // وموضع النقل في filtered (-1 = ترتيب النتائج لا يتغير)
+    int pendingFirst = 0;
+    int pendingLast = 0;
+    int pendingDestination = -1;
+    mutable int cachedRow = -1;
+    mutable SurahNode* cachedNode = nullptr;
+};
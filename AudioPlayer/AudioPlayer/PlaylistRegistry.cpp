@@ -0,0 +1,51 @@
+#include "PlaylistRegistry.h"
+
+PlaylistId PlaylistRegistry::add(const QSharedPointer<Playlist>& list)
+{
+    if (!list || nameIndex.contains(list->name)) return INVALID_PLAYLIST_ID;
+
+    PlaylistId id = PlaylistId(playlists.size());
+    list->id = id;
+
+    playlists.append(list);
+    nameIndex.insert(list->name, id);
+    positions.append(order.size());
+    order.append(id);
+    return id;
+}
+
+QSharedPointer<Playlist> PlaylistRegistry::get(PlaylistId id) const
+{
+    if (id < 0 || id >= playlists.size()) return QSharedPointer<Playlist>();
+    return playlists[id];
+}
+
+PlaylistId PlaylistRegistry::idOf(const QString& name) const
+{
+    return nameIndex.value(name, INVALID_PLAYLIST_ID);
+}
+
+bool PlaylistRegistry::rename(PlaylistId id, const QString& newName)
+{
+    QSharedPointer<Playlist> list = get(id);
+    if (!list || newName.isEmpty()) return false;
+    if (list->name == newName) return true;
+    if (nameIndex.contains(newName)) return false;
+
+    nameIndex.remove(list->name);
+    list->name = newName;
+    nameIndex.insert(newName, id);
+    return true;
+}
+
+PlaylistId PlaylistRegistry::idAt(int position) const
+{
+    if (position < 0 || position >= order.size()) return INVALID_PLAYLIST_ID;
+    return order[position];
+}
+
+int PlaylistRegistry::positionOf(PlaylistId id) const
+{
+    if (id < 0 || id >= positions.size()) return -1;
+    return positions[id];
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QSharedPointer>
+#include "Playlist.h"
+
+// --- سجل قوائم التشغيل (PlaylistRegistry) ---
+// كل قائمة لها رقم ثابت (PlaylistId) هو موضعها في مصفوفة playlists:
+//  - الوصول بالرقم O(1)
+//  - الاسم -> الرقم عبر جدول hash (O(1))
+//  - order يحفظ ترتيب القوائم كما تظهر في playlistSelector، و positions عكسه
+class PlaylistRegistry {
+public:
+    PlaylistId add(const QSharedPointer<Playlist>& list);
+
+    QSharedPointer<Playlist> get(PlaylistId id) const;
+    PlaylistId idOf(const QString& name) const;
+    bool contains(const QString& name) const { return nameIndex.contains(name); }
+
+    // يغير الاسم ويحدث جدول الأسماء فقط، الرقم والترتيب لا يتغيران
+    bool rename(PlaylistId id, const QString& newName);
+
+    int count() const { return order.size(); }
+    bool isEmpty() const { return order.isEmpty(); }
+    PlaylistId idAt(int position) const;
+    int positionOf(PlaylistId id) const;
+
+private:
+    QVector<QSharedPointer<Playlist>> playlists;
+    QHash<QString, PlaylistId> nameIndex;
+    QVector<PlaylistId> order;
+    QVector<int> positions;
+};
@@ -0,0 +1,111 @@
+#include "PlaylistSorter.h"
+#include "TrackCatalog.h"
+#include <QCollator>
+#include <QLocale>
+#include <algorithm>
+
+// مفاتيح رقمية: القيم السالبة (غير معروفة) تأتي في النهاية دائماً أياً كان اتجاه الترتيب
+static void sortByNumber(QVector<int>& rows, const QVector<qint64>& keys, Qt::SortOrder order)
+{
+    bool ascending = (order == Qt::AscendingOrder);
+    std::stable_sort(rows.begin(), rows.end(), [&](int a, int b) {
+        qint64 ka = keys[a];
+        qint64 kb = keys[b];
+        if ((ka < 0) != (kb < 0)) return kb < 0;
+        return ascending ? ka < kb : kb < ka;
+    });
+}
+
+QVector<int> PlaylistSorter::sortedOrder(const Playlist& list, Key key, Qt::SortOrder order)
+{
+    int total = list.count();
+    QVector<int> rows(total);
+    for (int i = 0; i < total; ++i) rows[i] = i;
+    if (total < 2) return rows;
+
+    const TrackCatalog& catalog = TrackCatalog::instance();
+
+    if (key == ByName) {
+        // مفتاح الترتيب يُحسب مرة واحدة لكل سورة، والمقارنة بعدها مقارنة بايتات
+        QCollator collator(QLocale(QLocale::Arabic));
+        collator.setNumericMode(true);
+        collator.setCaseSensitivity(Qt::CaseInsensitive);
+
+        QVector<QCollatorSortKey> keys;
+        keys.reserve(total);
+        for (SurahNode* node = list.head; node != nullptr; node = node->next) {
+            keys.append(collator.sortKey(node->name()));
+        }
+
+        bool ascending = (order == Qt::AscendingOrder);
+        std::stable_sort(rows.begin(), rows.end(), [&](int a, int b) {
+            return ascending ? keys[a].compare(keys[b]) < 0 : keys[b].compare(keys[a]) < 0;
+        });
+        return rows;
+    }
+
+    QVector<qint64> keys;
+    keys.reserve(total);
+    for (SurahNode* node = list.head; node != nullptr; node = node->next) {
+        const TrackInfo& info = catalog.info(node->pathId);
+        switch (key) {
+        case BySurahNumber:
+            // رقم المقطع في الوسم إن وجد، وإلا أول رقم في اسم الملف
+            keys.append(info.surahNumber >= 0 ? info.surahNumber : surahNumber(PathTable::instance().fileName(node->pathId)));
+            break;
+        case ByDuration:
+            keys.append(info.durationMs);
+            break;
+        case ByFileSize:
+            // الحجم من سجلات الفحص (LibraryCache) أو من قراءة الوسوم في الخلفية،
+            // والملف الذي لم يصل حجمه بعد يأتي في النهاية
+            keys.append(info.fileSize);
+            break;
+        case ByDateAdded:
+            keys.append(info.addedAt);
+            break;
+        case ByPlayCount:
+            keys.append(info.playCount);
+            break;
+        default:
+            keys.append(0);
+            break;
+        }
+    }
+
+    sortByNumber(rows, keys, order);
+    return rows;
+}
+
+int PlaylistSorter::surahNumber(const QString& fileName)
+{
+    int number = -1;
+    for (const QChar& c : fileName) {
+        int digit = c.digitValue();
+        if (digit >= 0) {
+            number = (number < 0 ? 0 : number * 10) + digit;
+            if (number > 100000) break;
+        }
+        else if (number >= 0) {
+            break;
+        }
+    }
+    return number;
+}
+
+bool PlaylistSorter::isIdentity(const QVector<int>& oldRows)
+{
+    for (int i = 0; i < oldRows.size(); ++i) {
+        if (oldRows[i] != i) return false;
+    }
+    return true;
+}
+
+QVector<int> PlaylistSorter::inverse(const QVector<int>& oldRows)
+{
+    QVector<int> result(oldRows.size());
+    for (int i = 0; i < oldRows.size(); ++i) {
+        result[oldRows[i]] = i;
+    }
+    return result;
+}
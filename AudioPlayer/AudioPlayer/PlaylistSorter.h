@@ -0,0 +1,29 @@
+#pragma once
+#include <QString>
+#include <QVector>
+#include "Playlist.h"
+
+// --- ترتيب القوائم (PlaylistSorter) ---
+// الترتيب يتم على مصفوفة أرقام صفوف (index sort) بمفاتيح محسوبة مسبقاً لكل سورة،
+// ثم تُعاد ربط القائمة مرة واحدة عبر Playlist::permute.
+// الترتيب مستقر: السور المتساوية في المفتاح تحافظ على ترتيبها الحالي.
+class PlaylistSorter {
+public:
+    enum Key {
+        ByName,         // ترتيب أبجدي حسب لغة النظام (مع دعم العربية)
+        BySurahNumber,  // رقم المقطع في الوسم، أو أول رقم في اسم الملف ("002 - البقرة.mp3")
+        ByDuration,
+        ByFileSize,
+        ByDateAdded,
+        ByPlayCount
+    };
+
+    // يعيد oldRows بحيث تصبح السورة في الصف oldRows[i] في الصف i
+    static QVector<int> sortedOrder(const Playlist& list, Key key, Qt::SortOrder order);
+
+    // -1 إن لم يوجد رقم في الاسم (يقبل الأرقام العربية ٠-٩ أيضاً)
+    static int surahNumber(const QString& fileName);
+
+    static bool isIdentity(const QVector<int>& oldRows);
+    static QVector<int> inverse(const QVector<int>& oldRows);
+};
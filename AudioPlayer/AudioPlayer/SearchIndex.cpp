@@ -0,0 +1,189 @@
+#include "SearchIndex.h"
+#include <algorithm>
+
+static const quint32 NO_NAME = 0xFFFFFFFFu;
+
+QString SearchIndex::normalize(QStringView text)
+{
+    QString result;
+    result.reserve(text.size());
+    bool pendingSpace = false;
+
+    for (QChar c : text) {
+        ushort code = c.unicode();
+
+        // التشكيل، الألف الخنجرية، التطويل، وعلامات المصحف (وأي علامة مركبة أخرى)
+        if ((code >= 0x064B && code <= 0x065F) || code == 0x0670 || code == 0x0640
+            || (code >= 0x06D6 && code <= 0x06ED) || c.isMark()) {
+            continue;
+        }
+
+        switch (code) {
+        case 0x0622: case 0x0623: case 0x0625: case 0x0671:   // آ أ إ ٱ
+            c = QChar(0x0627);
+            break;
+        case 0x0649: case 0x0626: case 0x06CC:                // ى ئ ی
+            c = QChar(0x064A);
+            break;
+        case 0x0624:                                          // ؤ
+            c = QChar(0x0648);
+            break;
+        case 0x0629:                                          // ة
+            c = QChar(0x0647);
+            break;
+        case 0x06A9:                                          // ک
+            c = QChar(0x0643);
+            break;
+        default:
+            break;
+        }
+
+        int digit = c.digitValue();
+        if (digit >= 0) {
+            c = QChar('0' + digit);
+        }
+        else if (!c.isLetter()) {
+            pendingSpace = !result.isEmpty();
+            continue;
+        }
+
+        if (pendingSpace) {
+            result.append(' ');
+            pendingSpace = false;
+        }
+        result.append(c.toCaseFolded());
+    }
+    return result;
+}
+
+QVector<quint64> SearchIndex::trigrams(QStringView text)
+{
+    QVector<quint64> keys;
+    if (text.size() < MIN_INDEXED_LENGTH) return keys;
+
+    keys.reserve(text.size() - 2);
+    for (int i = 0; i + 3 <= text.size(); ++i) {
+        keys.append((quint64(text[i].unicode()) << 32) | (quint64(text[i + 1].unicode()) << 16) | text[i + 2].unicode());
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+QStringView SearchIndex::normalizedName(PathId trackId) const
+{
+    if (int(trackId) >= nameOffsets.size() || nameOffsets[int(trackId)] == NO_NAME) return QStringView();
+    return QStringView(names).mid(nameOffsets[int(trackId)], nameLengths[int(trackId)]);
+}
+
+void SearchIndex::setName(PathId trackId, const QString& name)
+{
+    if (trackId == INVALID_PATH_ID) return;
+
+    QString normalized = normalize(name);
+    QStringView previous = normalizedName(trackId);
+    if (!previous.isNull() && previous == normalized) return;
+
+    // حذف السورة من قوائم ثلاثيات اسمها القديم
+    for (quint64 key : trigrams(previous)) {
+        auto it = postings.find(key);
+        if (it == postings.end()) continue;
+        QVector<PathId>& ids = it.value();
+        auto position = std::lower_bound(ids.begin(), ids.end(), trackId);
+        if (position != ids.end() && *position == trackId) ids.erase(position);
+        if (ids.isEmpty()) postings.erase(it);
+    }
+
+    int oldSize = nameOffsets.size();
+    if (int(trackId) >= oldSize) {
+        if (int(trackId) >= nameOffsets.capacity()) {
+            int capacity = qMax(int(trackId) + 1, 2 * nameOffsets.capacity());
+            nameOffsets.reserve(capacity);
+            nameLengths.reserve(capacity);
+        }
+        nameOffsets.resize(int(trackId) + 1);
+        nameLengths.resize(int(trackId) + 1);
+        for (int i = oldSize; i < nameOffsets.size(); ++i) {
+            nameOffsets[i] = NO_NAME;
+        }
+    }
+
+    // الاسم الجديد يُضاف لآخر المخزن (الاسم القديم يبقى مكانه غير مستخدم
+    // حتى تزيد الأحرف المهملة على المستخدمة فيُضغط المخزن)
+    liveLength -= previous.size();
+    nameOffsets[int(trackId)] = quint32(names.size());
+    nameLengths[int(trackId)] = quint32(normalized.size());
+    names.append(normalized);
+    liveLength += normalized.size();
+    if (names.size() - liveLength > liveLength) compactNames();
+
+    for (quint64 key : trigrams(normalized)) {
+        QVector<PathId>& ids = postings[key];
+        // السور الجديدة تأتي بأرقام متزايدة غالباً، فالإضافة في النهاية هي الحالة المعتادة
+        if (ids.isEmpty() || ids.last() < trackId) ids.append(trackId);
+        else ids.insert(std::lower_bound(ids.begin(), ids.end(), trackId), trackId);
+    }
+}
+
+void SearchIndex::compactNames()
+{
+    QString compacted;
+    compacted.reserve(liveLength);
+    for (int i = 0; i < nameOffsets.size(); ++i) {
+        if (nameOffsets[i] == NO_NAME) continue;
+        quint32 offset = quint32(compacted.size());
+        compacted.append(QStringView(names).mid(nameOffsets[i], nameLengths[i]));
+        nameOffsets[i] = offset;
+    }
+    names.swap(compacted);
+}
+
+bool SearchIndex::find(const QString& normalizedQuery, QVector<PathId>& result) const
+{
+    result.clear();
+    QVector<quint64> keys = trigrams(normalizedQuery);
+    if (keys.isEmpty()) return false;
+
+    QVector<const QVector<PathId>*> lists;
+    lists.reserve(keys.size());
+    for (quint64 key : keys) {
+        auto it = postings.constFind(key);
+        if (it == postings.constEnd()) return true;
+        lists.append(&it.value());
+    }
+
+    // التقاطع يبدأ بأقصر قائمة، وباقي القوائم يُبحث فيها ثنائياً
+    std::sort(lists.begin(), lists.end(), [](const QVector<PathId>* a, const QVector<PathId>* b) {
+        return a->size() < b->size();
+    });
+
+    result.reserve(lists.first()->size());
+    for (PathId trackId : *lists.first()) {
+        bool inAll = true;
+        for (int i = 1; i < lists.size() && inAll; ++i) {
+            inAll = std::binary_search(lists[i]->begin(), lists[i]->end(), trackId);
+        }
+        // الثلاثيات قد تكون كلها موجودة في الاسم بدون أن تكون متتالية
+        if (inAll && matches(trackId, normalizedQuery)) result.append(trackId);
+    }
+    return true;
+}
+
+bool SearchIndex::matches(PathId trackId, const QString& normalizedQuery) const
+{
+    QStringView name = normalizedName(trackId);
+    if (name.isNull()) return false;
+    return name.contains(normalizedQuery);
+}
+
+qint64 SearchIndex::memoryUsage() const
+{
+    qint64 total = sizeof(SearchIndex);
+    total += names.capacity() * sizeof(QChar);
+    total += nameOffsets.capacity() * sizeof(quint32) + nameLengths.capacity() * sizeof(quint32);
+    for (auto it = postings.constBegin(); it != postings.constEnd(); ++it) {
+        total += sizeof(quint64) + sizeof(QVector<PathId>) + 2 * sizeof(void*);
+        total += it.value().capacity() * sizeof(PathId);
+    }
+    return total;
+}
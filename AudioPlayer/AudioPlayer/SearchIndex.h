@@ -0,0 +1,45 @@
+#pragma once
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <QHash>
+#include "PathTable.h"
+
+// --- فهرس البحث (SearchIndex) ---
+// فهرس ثلاثيات الأحرف (trigrams) لأسماء السور بعد تطبيعها:
+//  - حذف التشكيل والتطويل وعلامات المصحف
+//  - توحيد الألف (أ إ آ ٱ -> ا)، والياء (ى ئ -> ي)، والواو (ؤ -> و)، والتاء المربوطة (ة -> ه)
+//  - الأرقام العربية -> 0-9، والحروف اللاتينية بدون حالة، وكل ما عدا ذلك مسافة
+// لكل ثلاثية قائمة مرتبة بأرقام السور، والبحث تقاطع أقصر القوائم أولاً
+// ثم تأكيد وجود النص فعلاً في الاسم المطبع المحفوظ.
+class SearchIndex {
+public:
+    // أقصر نص يمكن البحث عنه عبر الفهرس (الأقصر يُبحث عنه بالمرور على الأسماء)
+    static const int MIN_INDEXED_LENGTH = 3;
+
+    static QString normalize(QStringView text);
+
+    // يضيف السورة أو يحدّث اسمها (يحذف ثلاثيات الاسم القديم فقط)
+    void setName(PathId trackId, const QString& name);
+
+    // السور التي يحتوي اسمها المطبع على query، مرتبة تصاعدياً.
+    // يعيد false إن كان query أقصر من MIN_INDEXED_LENGTH (والنتيجة فارغة)
+    bool find(const QString& normalizedQuery, QVector<PathId>& result) const;
+
+    bool matches(PathId trackId, const QString& normalizedQuery) const;
+
+    int trigramCount() const { return postings.size(); }
+    qint64 memoryUsage() const;
+
+private:
+    QStringView normalizedName(PathId trackId) const;
+    static QVector<quint64> trigrams(QStringView text);
+    // ينسخ الأسماء المستخدمة فقط لمخزن جديد بنفس ترتيب السور
+    void compactNames();
+
+    QString names;                  // كل الأسماء المطبعة متتالية
+    int liveLength = 0;             // أحرف الأسماء الحالية في names (الباقي أسماء قديمة)
+    QVector<quint32> nameOffsets;   // بترقيم السور، NO_NAME = غير مفهرسة
+    QVector<quint32> nameLengths;
+    QHash<quint64, QVector<PathId>> postings;
+};
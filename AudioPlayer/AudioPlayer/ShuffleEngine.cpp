@@ -0,0 +1,176 @@
+#include "ShuffleEngine.h"
+#include <QRandomGenerator>
+
+ShuffleEngine::ShuffleEngine(int historyLimit) : historyLimit(qMax(1, historyLimit))
+{
+    history.resize(this->historyLimit);
+}
+
+void ShuffleEngine::reset(const Playlist* playlist, SurahNode* current)
+{
+    clear();
+    list = playlist;
+    if (list == nullptr) return;
+
+    order.reserve(list->count());
+    positions.reserve(list->count());
+    for (SurahNode* node = list->head; node != nullptr; node = node->next) {
+        positions.insert(node, order.size());
+        order.append(node);
+    }
+
+    // Fisher–Yates
+    for (int i = order.size() - 1; i > 0; --i) {
+        int j = int(QRandomGenerator::global()->bounded(quint32(i + 1)));
+        swapPositions(i, j);
+    }
+
+    // السورة الحالية تصبح أول ما "تم تشغيله"
+    int currentPosition = positions.value(current, -1);
+    if (currentPosition >= 0) {
+        swapPositions(currentPosition, 0);
+        cursor = 0;
+    }
+}
+
+void ShuffleEngine::clear()
+{
+    list = nullptr;
+    order.clear();
+    positions.clear();
+    cursor = -1;
+    historyStart = 0;
+    historyCount = 0;
+}
+
+SurahNode* ShuffleEngine::next()
+{
+    if (cursor + 1 >= order.size()) return nullptr;
+
+    if (cursor >= 0) pushHistory(order[cursor]);
+    cursor++;
+    return order[cursor];
+}
+
+SurahNode* ShuffleEngine::previous()
+{
+    if (cursor < 0) return nullptr;
+
+    SurahNode* node = popHistory();
+    if (node == nullptr) return nullptr;
+
+    // نضع السورة السابقة في موضع الحالية، والحالية تصبح أول ما لم يُشغل،
+    // فيعيد "التالي" بعدها نفس السورة التي رجعنا منها
+    int position = positions.value(node, -1);
+    if (position < cursor) {
+        swapPositions(position, cursor - 1);
+        cursor--;
+    }
+    else if (position > cursor) {
+        swapPositions(position, cursor + 1);
+        swapPositions(cursor, cursor + 1);
+    }
+    return node;
+}
+
+void ShuffleEngine::jumpTo(SurahNode* node)
+{
+    int position = positions.value(node, -1);
+    if (position < 0 || position == cursor) return;
+
+    if (cursor >= 0) pushHistory(order[cursor]);
+
+    if (position > cursor) {
+        swapPositions(position, cursor + 1);
+        cursor++;
+    }
+    else {
+        swapPositions(position, cursor);
+    }
+}
+
+void ShuffleEngine::onInserted(SurahNode* node)
+{
+    if (list == nullptr || positions.contains(node)) return;
+
+    // العقدة الجديدة تُوضع في مكان عشوائي بين ما لم يُشغل بعد
+    int last = order.size();
+    positions.insert(node, last);
+    order.append(node);
+
+    int first = cursor + 1;
+    int target = first + int(QRandomGenerator::global()->bounded(quint32(last - first + 1)));
+    swapPositions(target, last);
+}
+
+void ShuffleEngine::onRemoved(SurahNode* node)
+{
+    removeFromHistory(node);
+
+    int position = positions.value(node, -1);
+    if (position < 0) return;
+
+    int last = order.size() - 1;
+    if (position > cursor) {
+        swapPositions(position, last);
+    }
+    else {
+        // نبقي ما تم تشغيله في جهته والحالية في order[cursor]:
+        // المحذوفة تنتقل لموضع المؤشر، والحالية تنتقل خطوة للخلف،
+        // ثم يأخذ آخر عنصر (لم يُشغل) مكان المحذوفة ويرجع المؤشر خطوة
+        swapPositions(position, cursor);
+        if (position < cursor) swapPositions(position, cursor - 1);
+        swapPositions(cursor, last);
+        cursor--;
+    }
+
+    order.removeLast();
+    positions.remove(node);
+}
+
+void ShuffleEngine::swapPositions(int a, int b)
+{
+    if (a == b) return;
+
+    SurahNode* nodeA = order[a];
+    SurahNode* nodeB = order[b];
+    order[a] = nodeB;
+    order[b] = nodeA;
+    positions[nodeA] = b;
+    positions[nodeB] = a;
+}
+
+void ShuffleEngine::pushHistory(SurahNode* node)
+{
+    if (historyCount < historyLimit) {
+        history[(historyStart + historyCount) % historyLimit] = node;
+        historyCount++;
+    }
+    else {
+        // السجل ممتلئ: نكتب فوق الأقدم
+        history[historyStart] = node;
+        historyStart = (historyStart + 1) % historyLimit;
+    }
+}
+
+SurahNode* ShuffleEngine::popHistory()
+{
+    if (historyCount == 0) return nullptr;
+
+    historyCount--;
+    return history[(historyStart + historyCount) % historyLimit];
+}
+
+void ShuffleEngine::removeFromHistory(SurahNode* node)
+{
+    // السجل محدود الحجم، فالمرور عليه تكلفة ثابتة
+    int kept = 0;
+    for (int i = 0; i < historyCount; ++i) {
+        SurahNode* entry = history[(historyStart + i) % historyLimit];
+        if (entry != node) {
+            history[(historyStart + kept) % historyLimit] = entry;
+            kept++;
+        }
+    }
+    historyCount = kept;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <QVector>
+#include <QHash>
+#include "Playlist.h"
+
+// --- التشغيل العشوائي (ShuffleEngine) ---
+// يحفظ تبديلة عشوائية (Fisher–Yates) لعقد القائمة بدون تغيير روابطها:
+//  - order[0..cursor] : ما تم تشغيله، order[cursor] هي السورة الحالية
+//  - order[cursor+1..] : ما لم يُشغل بعد (بترتيب عشوائي)
+// الإضافة والحذف أثناء التشغيل O(1) بالتبديل مع آخر عنصر،
+// وسجل دائري محدود (history) يجعل "السابق" يعود للسورة التي شُغلت فعلاً قبل الحالية.
+class ShuffleEngine {
+public:
+    explicit ShuffleEngine(int historyLimit = 100);
+
+    void reset(const Playlist* list, SurahNode* current);
+    void clear();
+    const Playlist* playlist() const { return list; }
+
+    SurahNode* next();
+    SurahNode* previous();
+
+    // المستخدم اختار سورة بنفسه (نقر مزدوج) فتصبح هي الحالية
+    void jumpTo(SurahNode* node);
+
+    void onInserted(SurahNode* node);
+    void onRemoved(SurahNode* node);
+
+private:
+    void swapPositions(int a, int b);
+    void pushHistory(SurahNode* node);
+    SurahNode* popHistory();
+    void removeFromHistory(SurahNode* node);
+
+    const Playlist* list = nullptr;
+    QVector<SurahNode*> order;
+    QHash<SurahNode*, int> positions;
+    int cursor = -1;
+
+    QVector<SurahNode*> history;
+    int historyStart = 0;
+    int historyCount = 0;
+    int historyLimit;
+};
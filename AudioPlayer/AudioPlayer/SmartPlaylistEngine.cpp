@@ -0,0 +1,261 @@
+#include "SmartPlaylistEngine.h"
+#include "SearchIndex.h"
+#include <QDateTime>
+#include <QStringList>
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDir>
+#include <QStandardPaths>
+
+static const qint64 SECONDS_PER_DAY = 24 * 60 * 60;
+static const quint32 SMART_MAGIC = 0x51504C53;   // "QPLS"
+static const quint32 SMART_VERSION = 1;
+
+int SmartRule::dependencies() const
+{
+    // المجلد لا يتغير، وتاريخ الإضافة يُعالج في expire
+    int fields = 0;
+    if (!reciter.isEmpty()) fields |= TrackCatalog::TagsField;
+    if (minDurationMs >= 0 || maxDurationMs >= 0) fields |= TrackCatalog::DurationField;
+    if (minPlayCount > 0) fields |= TrackCatalog::PlayCountField;
+    return fields;
+}
+
+QString SmartRule::describe() const
+{
+    QStringList parts;
+    if (!folder.isEmpty()) parts << "المجلد: " + folder;
+    if (!reciter.isEmpty()) parts << "القارئ: " + reciter;
+    if (minDurationMs >= 0) parts << QString("المدة من %1 دقيقة").arg(minDurationMs / 60000);
+    if (maxDurationMs >= 0) parts << QString("المدة حتى %1 دقيقة").arg(maxDurationMs / 60000);
+    if (minPlayCount > 0) parts << QString("شُغلت %1 مرة على الأقل").arg(minPlayCount);
+    if (addedWithinDays > 0) parts << QString("أضيفت خلال %1 يوم").arg(addedWithinDays);
+    return parts.isEmpty() ? QString("كل السور") : parts.join("، ");
+}
+
+QString SmartPlaylistEngine::defaultPath()
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dir);
+    return dir + "/smart.playlists";
+}
+
+bool SmartPlaylistEngine::save(const QString& filePath, const QVector<SavedList>& saved)
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream << SMART_MAGIC << SMART_VERSION << quint32(saved.size());
+    for (const SavedList& list : saved) {
+        const SmartRule& rule = list.rule;
+        stream << list.name << rule.folder << rule.reciter << rule.minDurationMs << rule.maxDurationMs
+            << rule.minPlayCount << qint32(rule.addedWithinDays);
+    }
+
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+QVector<SmartPlaylistEngine::SavedList> SmartPlaylistEngine::load(const QString& filePath)
+{
+    QVector<SavedList> saved;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return saved;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic = 0, version = 0, count = 0;
+    stream >> magic >> version >> count;
+    if (magic != SMART_MAGIC || version != SMART_VERSION) return saved;
+
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        SavedList list;
+        SmartRule& rule = list.rule;
+        qint32 addedWithinDays = 0;
+        stream >> list.name >> rule.folder >> rule.reciter >> rule.minDurationMs >> rule.maxDurationMs
+            >> rule.minPlayCount >> addedWithinDays;
+        rule.addedWithinDays = addedWithinDays;
+        saved.append(list);
+    }
+
+    // ملف تالف: لا تُستعاد قائمة بنصف شروطها
+    if (stream.status() != QDataStream::Ok) saved.clear();
+    return saved;
+}
+
+int SmartPlaylistEngine::indexOf(PlaylistId id) const
+{
+    return listIndex.value(id, -1);
+}
+
+const SmartRule* SmartPlaylistEngine::rule(PlaylistId id) const
+{
+    int index = indexOf(id);
+    return index == -1 ? nullptr : &lists[index].rule;
+}
+
+bool SmartPlaylistEngine::contains(PlaylistId id, TrackId trackId) const
+{
+    int index = indexOf(id);
+    return index != -1 && lists[index].members.contains(trackId);
+}
+
+QString SmartPlaylistEngine::folderKey(const QString& directory)
+{
+    if (directory.isEmpty()) return QString();
+    // الشرطة في النهاية حتى لا يطابق "D:/Quran" المجلد "D:/QuranOld"
+    return PathTable::normalizedPath(directory) + '/';
+}
+
+SmartPlaylistEngine::TrackFacts SmartPlaylistEngine::factsOf(TrackId trackId)
+{
+    const TrackCatalog& catalog = TrackCatalog::instance();
+    TrackFacts facts;
+    facts.folderKey = folderKey(PathTable::instance().directory(trackId));
+    facts.reciterKey = SearchIndex::normalize(catalog.reciter(trackId));
+    facts.info = catalog.info(trackId);
+    return facts;
+}
+
+bool SmartPlaylistEngine::matches(const SmartList& list, const TrackFacts& facts, qint64 now)
+{
+    const SmartRule& rule = list.rule;
+    const TrackInfo& info = facts.info;
+
+    if (!list.folderKey.isEmpty() && !facts.folderKey.startsWith(list.folderKey)) return false;
+    if (!list.reciterKey.isEmpty() && facts.reciterKey != list.reciterKey) return false;
+    if (rule.minDurationMs >= 0 && (info.durationMs < 0 || info.durationMs < rule.minDurationMs)) return false;
+    if (rule.maxDurationMs >= 0 && (info.durationMs < 0 || info.durationMs > rule.maxDurationMs)) return false;
+    if (info.playCount < rule.minPlayCount) return false;
+    if (rule.addedWithinDays > 0 && info.addedAt < now - rule.addedWithinDays * SECONDS_PER_DAY) return false;
+    return true;
+}
+
+void SmartPlaylistEngine::notify(PlaylistId id, TrackId trackId, bool joined)
+{
+    Change change;
+    change.playlistId = id;
+    change.trackId = trackId;
+    change.joined = joined;
+    pending.append(change);
+}
+
+void SmartPlaylistEngine::join(SmartList& list, TrackId trackId, qint64 addedAt)
+{
+    list.members.insert(trackId);
+    if (list.rule.addedWithinDays > 0) list.byAddedAt.insert(addedAt, trackId);
+
+    notify(list.id, trackId, true);
+}
+
+void SmartPlaylistEngine::leave(SmartList& list, TrackId trackId, qint64 addedAt)
+{
+    list.members.remove(trackId);
+    if (list.rule.addedWithinDays > 0) {
+        for (auto it = list.byAddedAt.find(addedAt); it != list.byAddedAt.end() && it.key() == addedAt; ++it) {
+            if (it.value() == trackId) {
+                list.byAddedAt.erase(it);
+                break;
+            }
+        }
+    }
+
+    notify(list.id, trackId, false);
+}
+
+void SmartPlaylistEngine::update(SmartList& list, TrackId trackId, const TrackFacts& facts, qint64 now)
+{
+    bool member = list.members.contains(trackId);
+    bool match = matches(list, facts, now);
+    if (match && !member) join(list, trackId, facts.info.addedAt);
+    else if (!match && member) leave(list, trackId, facts.info.addedAt);
+}
+
+QVector<TrackId> SmartPlaylistEngine::addList(PlaylistId id, const SmartRule& rule)
+{
+    SmartList list;
+    list.id = id;
+    list.rule = rule;
+    list.dependencies = rule.dependencies();
+    list.folderKey = folderKey(rule.folder);
+    list.reciterKey = SearchIndex::normalize(rule.reciter);
+
+    // المرور الكامل الوحيد في حياة القائمة
+    QVector<TrackId> members;
+    qint64 now = QDateTime::currentSecsSinceEpoch();
+    for (TrackId trackId : TrackCatalog::instance().trackIds()) {
+        TrackFacts facts = factsOf(trackId);
+        if (!matches(list, facts, now)) continue;
+
+        list.members.insert(trackId);
+        if (rule.addedWithinDays > 0) list.byAddedAt.insert(facts.info.addedAt, trackId);
+        members.append(trackId);
+    }
+
+    listIndex.insert(id, lists.size());
+    lists.append(list);
+    return members;
+}
+
+void SmartPlaylistEngine::trackAdded(TrackId trackId)
+{
+    if (lists.isEmpty()) return;
+
+    TrackFacts facts = factsOf(trackId);
+    qint64 now = QDateTime::currentSecsSinceEpoch();
+    for (SmartList& list : lists) {
+        update(list, trackId, facts, now);
+    }
+}
+
+void SmartPlaylistEngine::trackRemoved(TrackId trackId)
+{
+    qint64 addedAt = TrackCatalog::instance().info(trackId).addedAt;
+    for (SmartList& list : lists) {
+        if (list.members.contains(trackId)) leave(list, trackId, addedAt);
+    }
+}
+
+void SmartPlaylistEngine::trackChanged(TrackId trackId, int fields)
+{
+    // الحقائق تُحسب فقط إن كانت هناك قائمة تعتمد على الحقل المتغير (مثلاً مرات التشغيل)
+    bool factsReady = false;
+    TrackFacts facts;
+    qint64 now = 0;
+
+    for (SmartList& list : lists) {
+        if (!(list.dependencies & fields)) continue;
+        if (!factsReady) {
+            facts = factsOf(trackId);
+            now = QDateTime::currentSecsSinceEpoch();
+            factsReady = true;
+        }
+        update(list, trackId, facts, now);
+    }
+}
+
+void SmartPlaylistEngine::expire(qint64 now)
+{
+    for (SmartList& list : lists) {
+        if (list.rule.addedWithinDays <= 0) continue;
+
+        qint64 cutoff = now - list.rule.addedWithinDays * SECONDS_PER_DAY;
+        while (!list.byAddedAt.isEmpty() && list.byAddedAt.firstKey() < cutoff) {
+            auto oldest = list.byAddedAt.begin();
+            TrackId trackId = oldest.value();
+            list.byAddedAt.erase(oldest);
+            list.members.remove(trackId);
+            notify(list.id, trackId, false);
+        }
+    }
+}
+
+QVector<SmartPlaylistEngine::Change> SmartPlaylistEngine::takeChanges()
+{
+    QVector<Change> changes;
+    changes.swap(pending);
+    return changes;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <QString>
+#include <QVector>
+#include <QSet>
+#include <QHash>
+#include <QMap>
+#include "Playlist.h"
+#include "TrackCatalog.h"
+
+// شروط القائمة الذكية، كلها يجب أن تتحقق (والشرط الفارغ يقبل أي سورة)
+struct SmartRule {
+    QString folder;                 // المجلد وما تحته، فارغ = أي مجلد
+    QString reciter;                // وسم القارئ (بعد التطبيع)، فارغ = أي قارئ
+    qint32 minDurationMs = -1;      // -1 = بدون حد، والسور مجهولة المدة لا تطابق أي حد
+    qint32 maxDurationMs = -1;
+    quint32 minPlayCount = 0;
+    int addedWithinDays = 0;        // 0 = بدون شرط
+
+    // حقول TrackCatalog التي قد يتغير الحكم على السورة بتغيرها
+    int dependencies() const;
+    QString describe() const;
+};
+
+// --- القوائم الذكية (SmartPlaylistEngine) ---
+// كل قائمة ذكية قائمة عادية في PlaylistRegistry، والمحرك يقرر فقط من ينضم ومن يخرج:
+//  - عند إنشاء القائمة: مرور واحد على الفهرس
+//  - بعد ذلك: كل سورة جديدة أو متغيرة تُفحص وحدها، وفقط ضد القوائم التي تعتمد على الحقل المتغير
+//  - شرط "أضيفت مؤخراً" يسقط السور القديمة عبر خريطة مرتبة بتاريخ الإضافة (بدون مرور على الأعضاء)
+// التغييرات تتجمع في pending وتطبقها الواجهة دفعة واحدة عبر takeChanges.
+class SmartPlaylistEngine {
+public:
+    struct Change {
+        PlaylistId playlistId;
+        TrackId trackId;
+        bool joined;
+    };
+
+    // ما يُحفظ من القائمة: اسمها وشروطها فقط، وأعضاؤها يُعاد بناؤهم من الفهرس عند البدء
+    struct SavedList {
+        QString name;
+        SmartRule rule;
+    };
+
+    static QString defaultPath();
+    static bool save(const QString& filePath, const QVector<SavedList>& saved);
+    static QVector<SavedList> load(const QString& filePath);
+
+    // يسجل القائمة ويعيد أعضاءها الحاليين (بترتيب إضافتهم للمكتبة)
+    QVector<TrackId> addList(PlaylistId id, const SmartRule& rule);
+
+    bool isSmart(PlaylistId id) const { return indexOf(id) != -1; }
+    const SmartRule* rule(PlaylistId id) const;
+    bool contains(PlaylistId id, TrackId trackId) const;
+    int listCount() const { return lists.size(); }
+
+    void trackAdded(TrackId trackId);
+    // الملف لم يعد موجوداً على القرص: يخرج من كل القوائم الذكية
+    void trackRemoved(TrackId trackId);
+    void trackChanged(TrackId trackId, int fields);
+
+    // يخرج السور التي تجاوزت مدة addedWithinDays
+    void expire(qint64 now);
+
+    bool hasChanges() const { return !pending.isEmpty(); }
+    QVector<Change> takeChanges();
+
+private:
+    // ما تحتاجه الشروط من السورة، يُحسب مرة واحدة لكل تغيير مهما كان عدد القوائم
+    struct TrackFacts {
+        QString folderKey;
+        QString reciterKey;
+        TrackInfo info;
+    };
+
+    struct SmartList {
+        PlaylistId id;
+        SmartRule rule;
+        int dependencies;
+        QString folderKey;
+        QString reciterKey;
+        QSet<TrackId> members;
+        QMultiMap<qint64, TrackId> byAddedAt;   // فقط إن كان للقائمة شرط addedWithinDays
+    };
+
+    int indexOf(PlaylistId id) const;
+    static QString folderKey(const QString& directory);
+    static TrackFacts factsOf(TrackId trackId);
+    static bool matches(const SmartList& list, const TrackFacts& facts, qint64 now);
+    void update(SmartList& list, TrackId trackId, const TrackFacts& facts, qint64 now);
+    void notify(PlaylistId id, TrackId trackId, bool joined);
+    void join(SmartList& list, TrackId trackId, qint64 addedAt);
+    void leave(SmartList& list, TrackId trackId, qint64 addedAt);
+
+    QVector<SmartList> lists;
+    QHash<PlaylistId, int> listIndex;
+    QVector<Change> pending;
+};
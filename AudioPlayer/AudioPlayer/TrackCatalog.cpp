@@ -0,0 +1,300 @@
+#include "TrackCatalog.h"
+#include "LibraryIndex.h"
+#include <QDateTime>
+
+TrackCatalog& TrackCatalog::instance()
+{
+    static TrackCatalog catalog;
+    return catalog;
+}
+
+PathId TrackCatalog::add(const QString& absolutePath, qint64 addedAt, quint32 playCount)
+{
+    PathTable& table = PathTable::instance();
+    PathId pathId = table.intern(absolutePath);
+
+    if (records.size() < table.fileCount()) {
+        records.resize(table.fileCount());
+    }
+
+    TrackId trackId = table.canonicalId(pathId);
+    TrackInfo& track = records[int(trackId)];
+    if (track.addedAt == 0 || track.removed) {
+        if (track.addedAt == 0) {
+            track.addedAt = addedAt != 0 ? addedAt : QDateTime::currentSecsSinceEpoch();
+            track.playCount = playCount;
+            indexName(trackId);
+        }
+        track.removed = false;
+        tracks++;
+        emit trackAdded(trackId);
+    }
+    return pathId;
+}
+
+QVector<PathId> TrackCatalog::restore(const LibraryIndex& index)
+{
+    PathTable& table = PathTable::instance();
+    QVector<PathId> pathIds;
+    if (table.fileCount() != 0 || !index.isOpen()) return pathIds;
+
+    int count = index.trackCount();
+    table.reserve(count);
+    QVector<quint32> directoryIds;
+    directoryIds.reserve(index.directoryCount());
+    for (int i = 0; i < index.directoryCount(); ++i) {
+        directoryIds.append(table.restoreDirectory(index.directory(i)));
+    }
+
+    // النص الواحد في الفهرس له موضع واحد، فالموضع يكفي لمعرفة رقمه هنا بدون فك UTF-8 مرة أخرى
+    QHash<quint32, quint32> tagIds;
+    auto restoreTag = [this, &index, &tagIds](const LibraryIndex::StringRef& ref) {
+        if (ref.length == 0) return TrackInfo::NO_TAG;
+        auto it = tagIds.constFind(ref.offset);
+        if (it != tagIds.constEnd()) return it.value();
+        quint32 tagId = internTag(index.text(ref));
+        tagIds.insert(ref.offset, tagId);
+        return tagId;
+    };
+
+    qint64 now = QDateTime::currentSecsSinceEpoch();
+    records.resize(count);
+    pathIds.reserve(count);
+    unindexedNames.reserve(unindexedNames.size() + count);
+    for (int i = 0; i < count; ++i) {
+        const LibraryIndex::TrackRecord& record = index.track(i);
+        QByteArray name = index.bytes(record.name);
+        PathId pathId = table.restoreFile(directoryIds[int(record.directory)], name.constData(), name.size());
+
+        TrackInfo& track = records[int(pathId)];
+        track.fileSize = record.fileSize;
+        track.durationMs = record.durationMs;
+        track.surahNumber = record.surahNumber;
+        track.tagsRead = record.flags & LibraryIndex::TagsRead;
+        track.addedAt = record.addedAt != 0 ? record.addedAt : now;
+        track.playCount = record.playCount;
+        track.title = restoreTag(record.title);
+        track.reciter = restoreTag(record.reciter);
+        track.album = restoreTag(record.album);
+
+        tracks++;
+        unindexedNames.append(pathId);
+        pathIds.append(pathId);
+    }
+    return pathIds;
+}
+
+PathId TrackCatalog::rename(PathId oldPathId, const QString& newPath)
+{
+    PathTable& table = PathTable::instance();
+    TrackId oldTrackId = trackOf(oldPathId);
+    PathId pathId = table.intern(newPath);
+    if (records.size() < table.fileCount()) {
+        records.resize(table.fileCount());
+    }
+
+    // تغيير حالة الأحرف فقط على Windows: نفس الملف ونفس السجل
+    TrackId trackId = table.canonicalId(pathId);
+    if (trackId == oldTrackId) return pathId;
+
+    TrackInfo& track = records[int(trackId)];
+    if (track.addedAt == 0 || track.removed) {
+        track = info(oldTrackId);
+        track.removed = false;
+        if (track.addedAt == 0) track.addedAt = QDateTime::currentSecsSinceEpoch();
+        tracks++;
+        indexName(trackId);
+        emit trackAdded(trackId);
+    }
+    retire(oldTrackId);
+    return pathId;
+}
+
+void TrackCatalog::retire(PathId pathId)
+{
+    TrackInfo* track = record(pathId);
+    if (track == nullptr || track->addedAt == 0 || track->removed) return;
+
+    track->removed = true;
+    tracks--;
+}
+
+TrackInfo* TrackCatalog::record(PathId pathId)
+{
+    TrackId trackId = trackOf(pathId);
+    if (trackId == INVALID_PATH_ID || int(trackId) >= records.size()) return nullptr;
+    return &records[int(trackId)];
+}
+
+const TrackInfo& TrackCatalog::info(PathId pathId) const
+{
+    static const TrackInfo unknown;
+    TrackId trackId = trackOf(pathId);
+    if (trackId == INVALID_PATH_ID || int(trackId) >= records.size()) return unknown;
+    return records[int(trackId)];
+}
+
+QString TrackCatalog::displayName(PathId pathId) const
+{
+    const TrackInfo& track = info(pathId);
+    if (track.title != TrackInfo::NO_TAG) return tags[int(track.title)];
+    return PathTable::instance().fileName(pathId);
+}
+
+void TrackCatalog::setFileSize(PathId pathId, qint64 size)
+{
+    TrackInfo* track = record(pathId);
+    if (track == nullptr || track->fileSize == size) return;
+
+    track->fileSize = size;
+    emit trackChanged(trackOf(pathId), FileSizeField);
+}
+
+void TrackCatalog::setDuration(PathId pathId, qint32 durationMs)
+{
+    TrackInfo* track = record(pathId);
+    if (track == nullptr || track->durationMs == durationMs) return;
+
+    track->durationMs = durationMs;
+    emit trackChanged(trackOf(pathId), DurationField);
+}
+
+void TrackCatalog::setTags(PathId pathId, const QString& title, const QString& reciter, const QString& album, int surahNumber)
+{
+    TrackInfo* track = record(pathId);
+    if (track == nullptr) return;
+
+    quint32 titleId = internTag(title);
+    quint32 reciterId = internTag(reciter);
+    quint32 albumId = internTag(album);
+    qint16 number = surahNumber > 0 && surahNumber <= 0x7FFF ? qint16(surahNumber) : qint16(-1);
+    track->tagsRead = true;
+    if (track->title == titleId && track->reciter == reciterId && track->album == albumId && track->surahNumber == number) return;
+
+    bool titleChanged = track->title != titleId;
+    track->title = titleId;
+    track->reciter = reciterId;
+    track->album = albumId;
+    track->surahNumber = number;
+    if (titleChanged) indexName(trackOf(pathId));
+    emit trackChanged(trackOf(pathId), TagsField);
+}
+
+void TrackCatalog::invalidate(PathId pathId)
+{
+    TrackInfo* track = record(pathId);
+    if (track == nullptr) return;
+
+    track->tagsRead = false;
+    if (track->durationMs < 0) return;
+    track->durationMs = -1;
+    emit trackChanged(trackOf(pathId), DurationField);
+}
+
+void TrackCatalog::recordPlay(PathId pathId)
+{
+    TrackInfo* track = record(pathId);
+    if (track == nullptr) return;
+
+    track->playCount++;
+    emit trackChanged(trackOf(pathId), PlayCountField);
+}
+
+void TrackCatalog::indexName(TrackId trackId)
+{
+    search.setName(trackId, displayName(trackId));
+    // فهرس الخلفية بُني من أسماء LibraryIndex، وهذا الاسم يُعاد عليه عند وصوله
+    if (!unindexedNames.isEmpty()) namedSinceRestore.append(trackId);
+}
+
+const SearchIndex& TrackCatalog::searchIndex() const
+{
+    // بحث قبل وصول فهرس الخلفية: يُبنى هنا، ونتيجة الخلفية تُهمل
+    for (TrackId trackId : unindexedNames) {
+        search.setName(trackId, displayName(trackId));
+    }
+    unindexedNames.clear();
+    return search;
+}
+
+TrackCatalog::RestoredIndexes TrackCatalog::buildRestoredIndexes(const LibraryIndex& index, const QVector<PathId>& pathIds)
+{
+    RestoredIndexes indexes;
+    if (pathIds.size() != index.trackCount()) return indexes;
+
+    QVector<QString> directories;
+    directories.reserve(index.directoryCount());
+    for (int i = 0; i < index.directoryCount(); ++i) {
+        directories.append(index.directory(i));
+    }
+
+    indexes.canonical.reserve(pathIds.size());
+    for (int i = 0; i < pathIds.size(); ++i) {
+        const LibraryIndex::TrackRecord& record = index.track(i);
+        QString name = index.text(record.name);
+        // نفس مفتاح PathTable::indexPendingCanonical ونفس الاسم الذي يعرضه displayName
+        QString normalized = PathTable::normalizedPath(directories[int(record.directory)] + name);
+        indexes.canonical.insert(uint(qHash(normalized)), pathIds[i]);
+        QString title = index.text(record.title);
+        indexes.search.setName(pathIds[i], title.isEmpty() ? name : title);
+    }
+    return indexes;
+}
+
+void TrackCatalog::adoptRestoredIndexes(RestoredIndexes& indexes)
+{
+    PathTable::instance().adoptCanonicalIndex(indexes.canonical);
+    if (unindexedNames.isEmpty()) {
+        namedSinceRestore.clear();
+        return;
+    }
+
+    for (TrackId trackId : namedSinceRestore) {
+        indexes.search.setName(trackId, displayName(trackId));
+    }
+    search = std::move(indexes.search);
+    unindexedNames.clear();
+    namedSinceRestore.clear();
+}
+
+QVector<TrackId> TrackCatalog::trackIds() const
+{
+    QVector<TrackId> ids;
+    ids.reserve(tracks);
+    for (int i = 0; i < records.size(); ++i) {
+        if (records[i].addedAt != 0 && !records[i].removed) ids.append(TrackId(i));
+    }
+    return ids;
+}
+
+quint32 TrackCatalog::internTag(const QString& text)
+{
+    QString trimmed = text.trimmed();
+    if (trimmed.isEmpty()) return TrackInfo::NO_TAG;
+
+    auto it = tagIndex.constFind(trimmed);
+    if (it != tagIndex.constEnd()) return it.value();
+
+    quint32 id = quint32(tags.size());
+    tags.append(trimmed);
+    tagIndex.insert(trimmed, id);
+    return id;
+}
+
+QString TrackCatalog::tag(quint32 tagId) const
+{
+    if (tagId == TrackInfo::NO_TAG || int(tagId) >= tags.size()) return QString();
+    return tags[int(tagId)];
+}
+
+qint64 TrackCatalog::memoryUsage() const
+{
+    qint64 total = sizeof(TrackCatalog);
+    total += records.capacity() * sizeof(TrackInfo);
+    for (const QString& text : tags) {
+        total += sizeof(QString) + (text.size() + 1) * sizeof(QChar);
+    }
+    total += tagIndex.size() * (sizeof(QString) + sizeof(quint32) + 2 * sizeof(void*));
+    total += search.memoryUsage() + unindexedNames.capacity() * sizeof(TrackId);
+    return total;
+}
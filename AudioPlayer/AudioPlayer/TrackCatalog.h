@@ -0,0 +1,119 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include "PathTable.h"
+#include "SearchIndex.h"
+
+class LibraryIndex;
+
+// رقم السورة في الفهرس هو canonicalId لمسارها: كل الصيغ المختلفة لنفس الملف سجل واحد
+typedef PathId TrackId;
+
+// بيانات الملف، محفوظة مرة واحدة مهما كان عدد القوائم التي تحتويه
+struct TrackInfo {
+    static const quint32 NO_TAG = 0xFFFFFFFFu;
+
+    qint64 fileSize = -1;       // -1 = غير معروف بعد
+    qint32 durationMs = -1;     // -1 = غير معروف (يُعرف عند أول تشغيل)
+    qint16 surahNumber = -1;    // رقم المقطع في الوسم، -1 = غير موجود
+    bool tagsRead = false;      // قُرئت وسوم الملف (ولو لم يكن فيه وسم)
+    qint64 addedAt = 0;         // أول مرة أضيف فيها الملف للمكتبة (ثوانٍ منذ 1970)
+    quint32 playCount = 0;
+    bool removed = false;       // حُذف الملف من القرص أو أعيدت تسميته (السجل يبقى إن عاد)
+
+    // أرقام نصوص في جدول الوسوم المشترك (اسم القارئ مثلاً يتكرر في 114 سورة ويُخزن مرة)
+    quint32 title = NO_TAG;
+    quint32 reciter = NO_TAG;
+    quint32 album = NO_TAG;
+};
+
+// --- فهرس السور المشترك (TrackCatalog) ---
+// سجل واحد لكل ملف فريد فوق PathTable. العقد في القوائم لا تحمل إلا رقم المسار،
+// فأي تحديث هنا (المدة، الوسوم، مرات التشغيل) يظهر في كل القوائم فوراً،
+// وإشارة trackChanged تخبر الواجهة بالسورة التي تغيرت فقط.
+class TrackCatalog : public QObject {
+    Q_OBJECT
+public:
+    enum Field {
+        FileSizeField = 0x1,
+        DurationField = 0x2,
+        PlayCountField = 0x4,
+        TagsField = 0x8
+    };
+
+    static TrackCatalog& instance();
+
+    // يضيف المسار لجدول المسارات وينشئ سجل الملف إن لم يكن موجوداً
+    // (ملف حُذف ثم عاد يرجع بتاريخه ويُعلن عنه بـ trackAdded من جديد).
+    // addedAt و playCount: تاريخ السورة المحفوظ في library.cache، 0 = سورة جديدة الآن
+    PathId add(const QString& absolutePath, qint64 addedAt = 0, quint32 playCount = 0);
+
+    // يملأ الجداول من فهرس مفتوح عند البدء (قبل أي add)، ويعيد رقم المسار لكل سجل فيه
+    // بنفس ترتيبه. لا يرسل trackAdded، وأسماء هذه السور تُفهرس للبحث في الخلفية
+    // (buildRestoredIndexes) أو عند أول بحث إن سبقها
+    QVector<PathId> restore(const LibraryIndex& index);
+
+    // ما يؤجله restore: توحيد المسارات المستعادة (PathTable) وفهرس البحث في أسمائها
+    struct RestoredIndexes {
+        QMultiHash<uint, PathId> canonical;
+        SearchIndex search;
+    };
+    // يُستدعى على خيط آخر بنسخة خاصة من نفس الفهرس، ولا يلمس الجداول المشتركة
+    static RestoredIndexes buildRestoredIndexes(const LibraryIndex& index, const QVector<PathId>& pathIds);
+    // على الخيط الرئيسي: يأخذ النتيجة إن لم يسبقها intern أو بحث بنى الفهارس بنفسه
+    void adoptRestoredIndexes(RestoredIndexes& indexes);
+
+    // ملف أعيدت تسميته: السجل الجديد يرث المدة والوسوم وتاريخ الإضافة ومرات التشغيل،
+    // والقديم يخرج من المكتبة
+    PathId rename(PathId oldPathId, const QString& newPath);
+    // الملف لم يعد على القرص: لا يظهر في trackIds (والقوائم الذكية)
+    void retire(PathId pathId);
+
+    TrackId trackOf(PathId pathId) const { return PathTable::instance().canonicalId(pathId); }
+    const TrackInfo& info(PathId pathId) const;
+
+    // العنوان من الوسوم إن وجد، وإلا اسم الملف
+    QString displayName(PathId pathId) const;
+    QString title(PathId pathId) const { return tag(info(pathId).title); }
+    QString reciter(PathId pathId) const { return tag(info(pathId).reciter); }
+    QString album(PathId pathId) const { return tag(info(pathId).album); }
+
+    void setFileSize(PathId pathId, qint64 size);
+    void setDuration(PathId pathId, qint32 durationMs);
+    // يعتبر الوسوم مقروءة حتى لو كانت كلها فارغة
+    void setTags(PathId pathId, const QString& title, const QString& reciter, const QString& album, int surahNumber = -1);
+    // الملف تغير على القرص: المدة تُنسى والوسوم تُقرأ من جديد
+    // (القديمة تبقى معروضة حتى تصل الجديدة)
+    void invalidate(PathId pathId);
+    void recordPlay(PathId pathId);
+
+    // فهرس البحث في أسماء السور، يُحدّث مع كل سورة جديدة وكل تغيير في العنوان
+    const SearchIndex& searchIndex() const;
+
+    // كل السور الموجودة على القرص بترتيب إضافتها للمكتبة
+    QVector<TrackId> trackIds() const;
+    int trackCount() const { return tracks; }
+    qint64 memoryUsage() const;
+
+signals:
+    void trackAdded(TrackId trackId);
+    void trackChanged(TrackId trackId, int fields);
+
+private:
+    TrackCatalog() = default;
+
+    TrackInfo* record(PathId pathId);
+    quint32 internTag(const QString& text);
+    QString tag(quint32 tagId) const;
+    void indexName(TrackId trackId);
+
+    QVector<TrackInfo> records;     // بترقيم PathTable، وتُستخدم خانة canonicalId فقط
+    int tracks = 0;
+    QVector<QString> tags;
+    QHash<QString, quint32> tagIndex;
+    mutable SearchIndex search;
+    mutable QVector<TrackId> unindexedNames;    // مستعادة من LibraryIndex
+    QVector<TrackId> namedSinceRestore;         // أسماء تغيرت قبل وصول فهرس الخلفية
+};
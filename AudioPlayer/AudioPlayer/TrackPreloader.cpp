@@ -0,0 +1,69 @@
+#include "TrackPreloader.h"
+#include <QThreadPool>
+#include <string>
+
+TrackPreloader::Job::~Job()
+{
+    // لم يأخذه أحد (أُلغي أو تغيرت السورة التالية)
+    if (decoder != nullptr) {
+        if (opened) ::ma_decoder_uninit(decoder);
+        delete decoder;
+    }
+}
+
+TrackPreloader::~TrackPreloader()
+{
+    // الخيط يحتفظ بنسخة من Job، فالإلغاء لا ينتظر انتهاء الفتح
+    cancel();
+}
+
+void TrackPreloader::prepare(SurahNode* node)
+{
+    if (node == nullptr) {
+        cancel();
+        return;
+    }
+    if (job && job->node == node) return;
+
+    QSharedPointer<Job> next(new Job);
+    next->node = node;
+    next->path = node->path();
+    next->decoder = new ma_decoder;
+    job = next;
+
+    QThreadPool::globalInstance()->start([next]() {
+        std::wstring wFilePath = next->path.toStdWString();
+        next->opened = ::ma_decoder_init_file_w(wFilePath.c_str(), NULL, next->decoder) == MA_SUCCESS;
+        next->done.release();
+    });
+}
+
+ma_decoder* TrackPreloader::take(SurahNode* node)
+{
+    if (!job || job->node != node) return nullptr;
+
+    QSharedPointer<Job> ready = job;
+    job.reset();
+
+    // لا انتظار على خيط الواجهة: إن لم ينته الفتح بعد (قرص بطيء أو شبكة) يفتح المستدعي
+    // الملف بنفسه، والخيط يكمل على نسخته من Job ويحرر ما فتحه عند انتهائه
+    if (!ready->done.tryAcquire()) return nullptr;
+    if (!ready->opened) return nullptr;
+
+    // للحماية: خانة العقدة قد يُعاد استخدامها لملف آخر بعد بدء الفتح
+    if (ready->path != node->path()) return nullptr;
+
+    ma_decoder* decoder = ready->decoder;
+    ready->decoder = nullptr;
+    return decoder;
+}
+
+void TrackPreloader::cancel()
+{
+    job.reset();
+}
+
+SurahNode* TrackPreloader::pendingNode() const
+{
+    return job ? job->node : nullptr;
+}
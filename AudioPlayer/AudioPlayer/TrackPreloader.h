@@ -0,0 +1,41 @@
+#pragma once
+#include <QString>
+#include <QSharedPointer>
+#include <QSemaphore>
+#include "miniaudio.h"
+#include "Playlist.h"
+
+// --- الفتح المسبق للسورة التالية (TrackPreloader) ---
+// يفتح ملف السورة التالية في الطابور (ma_decoder) على خيط من QThreadPool،
+// فعند الانتقال إليها يأخذ المشغل الملف جاهزاً بدل فتحه وقراءة ترويسته وقتها.
+class TrackPreloader {
+public:
+    TrackPreloader() = default;
+    ~TrackPreloader();
+
+    TrackPreloader(const TrackPreloader&) = delete;
+    TrackPreloader& operator=(const TrackPreloader&) = delete;
+
+    // يبدأ فتح السورة في الخلفية (لا شيء إن كانت هي نفسها قيد التحضير)
+    void prepare(SurahNode* node);
+
+    // يعيد الملف المفتوح لهذه العقدة إن انتهى فتحه، وإلا nullptr (بلا انتظار، والمستدعي يفتحه بنفسه)،
+    // والمستدعي يملك النتيجة: ma_decoder_uninit ثم delete
+    ma_decoder* take(SurahNode* node);
+
+    void cancel();
+    SurahNode* pendingNode() const;
+
+private:
+    struct Job {
+        ~Job();
+
+        SurahNode* node = nullptr;
+        QString path;
+        ma_decoder* decoder = nullptr;
+        bool opened = false;
+        QSemaphore done;
+    };
+
+    QSharedPointer<Job> job;
+};
@@ -1,14 +1,42 @@
-﻿#include "AudioPlayer.h"
+#include "AudioPlayer.h"
+#include "PathTable.h"
+#include "Playlist.h"
+#include "LibraryIndex.h"
 #include <QtWidgets/QApplication>
 
 int main(int argc, char* argv[])
 {
     QApplication a(argc, argv);
 
+    if (a.arguments().contains("--memory-report")) {
+        PathTable::printMemoryReport(100000);
+        SurahNodePool::printAllocationReport(100000);
+        return 0;
+    }
+    if (a.arguments().contains("--startup-benchmark")) {
+        LibraryIndex::printStartupBenchmark(100000);
+        return 0;
+    }
+
 
     a.setStyle("fusion");
 
     AudioPlayer w;
     w.show();
+
+    // أي ملفات أو مجلدات تُمرر في سطر الأوامر تضاف للقائمة الافتراضية
+    QStringList paths;
+    for (const QString& argument : a.arguments().mid(1)) {
+        if (argument.startsWith("--undo-limit=")) {
+            w.setUndoLimit(argument.section('=', 1).toInt());
+        }
+        else if (!argument.startsWith("--")) {
+            paths.append(argument);
+        }
+    }
+    if (!paths.isEmpty()) {
+        w.importPaths(paths);
+    }
+
     return a.exec();
 }
\ No newline at end of file
@@ -0,0 +1,240 @@
+#include "EditJournalTests.h"
+#include "PathTable.h"
+#include <QtTest/QtTest>
+
+PathId EditJournalTests::track(const QString& name)
+{
+    return PathTable::instance().intern("D:/QuranTests/Journal/" + name + ".mp3");
+}
+
+void EditJournalTests::init()
+{
+    journal.clear();
+}
+
+void EditJournalTests::cleanup()
+{
+    list.clear();
+}
+
+void EditJournalTests::fill(const QString& names)
+{
+    scanInsert(list.count(), names);
+}
+
+QString EditJournalTests::order() const
+{
+    QStringList names;
+    for (const SurahNode* node = list.head; node != nullptr; node = node->next) {
+        names << PathTable::instance().fileName(node->pathId).chopped(4);
+    }
+    return names.join(' ');
+}
+
+void EditJournalTests::recordRemove(int row, int count)
+{
+    PlaylistEdit edit;
+    edit.type = PlaylistEdit::RemoveRows;
+    edit.row = row;
+    SurahNode* before = list.at(row - 1);
+    edit.anchor = before ? before->pathId : INVALID_PATH_ID;
+    for (SurahNode* node : list.removeRange(row, count)) {
+        edit.pathIds.append(node->pathId);
+        list.destroyNode(node);
+    }
+    journal.record(EditStep() << edit);
+}
+
+void EditJournalTests::recordMove(int row, int count, int newRow)
+{
+    PlaylistEdit edit;
+    edit.type = PlaylistEdit::MoveRows;
+    edit.row = row;
+    edit.count = count;
+    edit.newRow = newRow;
+    for (SurahNode* node = list.at(row); node != nullptr && edit.pathIds.size() < count; node = node->next) {
+        edit.pathIds.append(node->pathId);
+    }
+    list.moveRange(row, count, newRow);
+    journal.record(EditStep() << edit);
+}
+
+void EditJournalTests::recordSort(const QVector<int>& oldRows)
+{
+    PlaylistEdit edit;
+    edit.type = PlaylistEdit::ReorderRows;
+    edit.rowOrder = oldRows;
+    for (SurahNode* node = list.head; node != nullptr; node = node->next) {
+        edit.pathIds.append(node->pathId);
+    }
+    list.permute(oldRows);
+    journal.record(EditStep() << edit);
+}
+
+void EditJournalTests::scanInsert(int row, const QString& names)
+{
+    QVector<SurahNode*> nodes;
+    for (const QString& name : names.split(' ', Qt::SkipEmptyParts)) {
+        SurahNode* node = list.createNode();
+        node->pathId = track(name);
+        nodes.append(node);
+    }
+    list.insertBatch(row, nodes);
+}
+
+void EditJournalTests::scanRemove(const QString& name)
+{
+    SurahNode* node = list.findPath(track(name));
+    if (node == nullptr) return;
+    list.remove(node);
+    list.destroyNode(node);
+}
+
+// نفس ما يفعله AudioPlayer::applyEdit بالعمليات التي يعيدها resolve
+bool EditJournalTests::apply(const EditStep& step, bool reverse)
+{
+    bool applied = false;
+    for (int i = 0; i < step.size(); ++i) {
+        const PlaylistEdit& edit = step[reverse ? step.size() - 1 - i : i];
+        EditStep operations = EditJournal::resolve(list, edit, reverse);
+        for (const PlaylistEdit& operation : operations) {
+            if (operation.type == PlaylistEdit::InsertRows) {
+                QVector<SurahNode*> nodes;
+                for (PathId pathId : operation.pathIds) {
+                    SurahNode* node = list.createNode();
+                    node->pathId = pathId;
+                    nodes.append(node);
+                }
+                list.insertBatch(operation.row, nodes);
+            }
+            else if (operation.type == PlaylistEdit::RemoveRows) {
+                for (SurahNode* node : list.removeRange(operation.row, operation.count)) {
+                    list.destroyNode(node);
+                }
+            }
+            else if (operation.type == PlaylistEdit::MoveRows) {
+                list.moveRange(operation.row, operation.count, operation.newRow);
+            }
+            else if (operation.type == PlaylistEdit::ReorderRows) {
+                list.permute(operation.rowOrder);
+            }
+        }
+        applied |= !operations.isEmpty();
+    }
+    return applied;
+}
+
+bool EditJournalTests::undo()
+{
+    if (!journal.canUndo()) return false;
+    if (apply(journal.takeUndo(), true)) return true;
+    journal.dropUndone();
+    return false;
+}
+
+bool EditJournalTests::redo()
+{
+    if (!journal.canRedo()) return false;
+    if (apply(journal.takeRedo(), false)) return true;
+    journal.dropRedone();
+    return false;
+}
+
+void EditJournalTests::removeRoundTripAfterScan()
+{
+    fill("A B C D E F G H");
+    recordRemove(2, 2);
+    QCOMPARE(order(), QString("A B E F G H"));
+
+    // الفحص حذف ملفاً فوق الصفوف المحذوفة وأضاف ملفاً في آخر القائمة
+    scanRemove("A");
+    scanInsert(list.count(), "X");
+
+    QVERIFY(undo());
+    QCOMPARE(order(), QString("B C D E F G H X"));
+    QVERIFY(redo());
+    QCOMPARE(order(), QString("B E F G H X"));
+    QVERIFY(undo());
+    QCOMPARE(order(), QString("B C D E F G H X"));
+}
+
+void EditJournalTests::removeRedoAfterScanInsertInside()
+{
+    fill("A B C D E F G H");
+    recordRemove(2, 3);
+    QVERIFY(undo());
+    QCOMPARE(order(), QString("A B C D E F G H"));
+
+    // ملف جديد بين الصفوف: لم تعد متتالية، فتُحذف كل سورة من مكانها
+    scanInsert(3, "X");
+    QVERIFY(redo());
+    QCOMPARE(order(), QString("A B X F G H"));
+    QVERIFY(undo());
+    QCOMPARE(order(), QString("A B C D E X F G H"));
+}
+
+void EditJournalTests::removeRoundTripWithDuplicates()
+{
+    fill("A B A C A D");
+    recordRemove(4, 1);
+    QCOMPARE(order(), QString("A B A C D"));
+
+    // السورة تعود بعد C (السورة التي كانت قبلها) وليس بعد أول A
+    scanInsert(0, "X Y");
+    QVERIFY(undo());
+    QCOMPARE(order(), QString("X Y A B A C A D"));
+    QVERIFY(redo());
+    QCOMPARE(order(), QString("X Y A B A C D"));
+}
+
+void EditJournalTests::moveRoundTripAfterScan()
+{
+    fill("A B C D E F G H");
+    recordMove(1, 2, 5);
+    QCOMPARE(order(), QString("A D E F G B C H"));
+
+    scanRemove("A");
+    scanInsert(list.count(), "X");
+
+    QVERIFY(undo());
+    QCOMPARE(order(), QString("B C D E F G H X"));
+    QVERIFY(redo());
+    QCOMPARE(order(), QString("D E F G B C H X"));
+
+    // الفحص أضاف ملفاً قبل السور المنقولة: موضعها الجديد ينزاح معها
+    scanInsert(0, "Y");
+    QVERIFY(undo());
+    QCOMPARE(order(), QString("Y B C D E F G H X"));
+}
+
+void EditJournalTests::sortRoundTripAfterScan()
+{
+    fill("D B A C");
+    // الصف الجديد i = الصف القديم oldRows[i]: A B C D
+    recordSort(QVector<int>() << 2 << 1 << 3 << 0);
+    QCOMPARE(order(), QString("A B C D"));
+
+    // ما أضافه الفحص يبقى في صفه، وما حذفه يُتجاهل
+    scanInsert(0, "X");
+    scanRemove("C");
+
+    QVERIFY(undo());
+    QCOMPARE(order(), QString("X D B A"));
+    QVERIFY(redo());
+    QCOMPARE(order(), QString("X A B D"));
+}
+
+void EditJournalTests::editOfVanishedTracksIsDropped()
+{
+    fill("A B C D");
+    recordMove(0, 2, 2);
+    QCOMPARE(order(), QString("C D A B"));
+
+    // الفحص حذف كل السور المنقولة: التراجع لا يجد شيئاً ويُسقط الخطوة
+    scanRemove("A");
+    scanRemove("B");
+    QVERIFY(!undo());
+    QVERIFY(!journal.canUndo());
+    QVERIFY(!journal.canRedo());
+    QCOMPARE(order(), QString("C D"));
+}
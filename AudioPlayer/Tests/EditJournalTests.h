@@ -0,0 +1,45 @@
+#pragma once
+#include <QObject>
+#include <QStringList>
+#include "EditJournal.h"
+#include "Playlist.h"
+
+// --- اختبارات التراجع والإعادة ---
+// كل اختبار يسجل تعديلاً كما يسجله AudioPlayer، ثم يغير القائمة بدون تسجيل كما يفعل
+// الفحص والمراقب، ثم يتراجع ويعيد عبر EditJournal::resolve ويقارن ترتيب السور
+class EditJournalTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void removeRoundTripAfterScan();
+    void removeRedoAfterScanInsertInside();
+    void removeRoundTripWithDuplicates();
+    void moveRoundTripAfterScan();
+    void sortRoundTripAfterScan();
+    void editOfVanishedTracksIsDropped();
+
+private:
+    // "A B C" -> سور بأسماء ملفات A.mp3 B.mp3 C.mp3
+    static PathId track(const QString& name);
+    void fill(const QString& names);
+    QString order() const;
+
+    // نفس التعديلات التي يسجلها AudioPlayer
+    void recordRemove(int row, int count);
+    void recordMove(int row, int count, int newRow);
+    void recordSort(const QVector<int>& oldRows);
+
+    // تغييرات الفحص: بلا تسجيل
+    void scanInsert(int row, const QString& names);
+    void scanRemove(const QString& name);
+
+    bool undo();
+    bool redo();
+    bool apply(const EditStep& step, bool reverse);
+
+    Playlist list;
+    EditJournal journal;
+};
@@ -0,0 +1,216 @@
+#include "PlaylistTests.h"
+#include "PathTable.h"
+#include <QtTest/QtTest>
+#include <algorithm>
+
+// يفحص الشجرة الفرعية: الحجم المخزن، ورابط الأب لكل ابن، ويعيد عدد عقدها (-1 عند الخطأ)
+static int checkSubtree(const SurahNode* node)
+{
+    if (node == nullptr) return 0;
+    if (node->left && node->left->parent != node) return -1;
+    if (node->right && node->right->parent != node) return -1;
+
+    int leftSize = checkSubtree(node->left);
+    int rightSize = checkSubtree(node->right);
+    if (leftSize < 0 || rightSize < 0) return -1;
+    if (node->size != 1 + leftSize + rightSize) return -1;
+    return node->size;
+}
+
+void PlaylistTests::init()
+{
+    // بذرة ثابتة لكل اختبار: أي فشل يتكرر بنفس السلسلة
+    random.seed(20240601);
+}
+
+void PlaylistTests::cleanup()
+{
+    list.clear();
+    expected.clear();
+}
+
+QVector<SurahNode*> PlaylistTests::createNodes(int count)
+{
+    QVector<SurahNode*> nodes;
+    nodes.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        SurahNode* node = list.createNode();
+        node->pathId = PathTable::instance().intern(QString("D:/QuranTests/%1.mp3").arg(nextFile++));
+        nodes.append(node);
+    }
+    return nodes;
+}
+
+void PlaylistTests::verify()
+{
+    QCOMPARE(list.count(), expected.size());
+    QCOMPARE(list.pathIndex.size(), expected.size());
+    QCOMPARE(checkSubtree(list.root), expected.size());
+    if (list.root) QVERIFY(list.root->parent == nullptr);
+
+    // القائمة المترابطة في الاتجاهين
+    const SurahNode* previous = nullptr;
+    int row = 0;
+    for (const SurahNode* node = list.head; node != nullptr; node = node->next, ++row) {
+        QVERIFY(row < expected.size());
+        QVERIFY(node == expected[row]);
+        QVERIFY(node->prev == previous);
+        previous = node;
+    }
+    QCOMPARE(row, expected.size());
+    QVERIFY(list.tail == previous);
+
+    // الرقم <-> العقدة
+    for (int i = 0; i < expected.size(); ++i) {
+        QVERIFY(list.at(i) == expected[i]);
+        QCOMPARE(list.indexOf(expected[i]), i);
+        QVERIFY(list.pathIndex.contains(PathTable::instance().canonicalId(expected[i]->pathId), expected[i]));
+    }
+    QVERIFY(list.at(expected.size()) == nullptr);
+}
+
+void PlaylistTests::insertBatchKeepsOrder()
+{
+    QVector<SurahNode*> nodes = createNodes(10);
+    list.appendBatch(nodes);
+    expected = nodes;
+    verify();
+    if (QTest::currentTestFailed()) return;
+
+    // في البداية والوسط والنهاية
+    const int rows[] = { 0, 5, 12, 100 };
+    for (int row : rows) {
+        QVector<SurahNode*> batch = createNodes(3);
+        list.insertBatch(row, batch);
+        int at = qBound(0, row, expected.size());
+        for (int i = 0; i < batch.size(); ++i) expected.insert(at + i, batch[i]);
+        verify();
+        if (QTest::currentTestFailed()) return;
+    }
+}
+
+void PlaylistTests::removeRangeKeepsOrder()
+{
+    expected = createNodes(20);
+    list.appendBatch(expected);
+
+    QVector<SurahNode*> removed = list.removeRange(0, 3);
+    QVERIFY(removed == expected.mid(0, 3));
+    expected.remove(0, 3);
+    for (SurahNode* node : removed) list.destroyNode(node);
+    verify();
+    if (QTest::currentTestFailed()) return;
+
+    // العدد أكبر من الباقي يُقص إلى آخر القائمة
+    removed = list.removeRange(14, 10);
+    QVERIFY(removed == expected.mid(14));
+    expected.remove(14, expected.size() - 14);
+    for (SurahNode* node : removed) list.destroyNode(node);
+    verify();
+    if (QTest::currentTestFailed()) return;
+
+    QVERIFY(list.removeRange(expected.size(), 1).isEmpty());
+    QVERIFY(list.removeRange(-1, 1).isEmpty());
+    verify();
+}
+
+void PlaylistTests::moveRangeKeepsOrder()
+{
+    expected = createNodes(10);
+    list.appendBatch(expected);
+
+    struct Move { int row, count, newRow; };
+    const Move moves[] = { { 0, 3, 7 }, { 7, 3, 0 }, { 4, 2, 5 }, { 0, 10, 0 }, { 9, 1, 0 }, { 0, 1, 9 } };
+    for (const Move& move : moves) {
+        list.moveRange(move.row, move.count, move.newRow);
+        QVector<SurahNode*> block = expected.mid(move.row, move.count);
+        expected.remove(move.row, move.count);
+        for (int i = 0; i < block.size(); ++i) expected.insert(move.newRow + i, block[i]);
+        verify();
+        if (QTest::currentTestFailed()) return;
+    }
+}
+
+void PlaylistTests::permuteKeepsOrder()
+{
+    expected = createNodes(50);
+    list.appendBatch(expected);
+
+    QVector<int> oldRows;
+    for (int i = expected.size() - 1; i >= 0; --i) oldRows.append(i);
+    list.permute(oldRows);
+    std::reverse(expected.begin(), expected.end());
+    verify();
+    if (QTest::currentTestFailed()) return;
+
+    // ترتيب بطول مختلف يُتجاهل
+    list.permute(oldRows.mid(1));
+    verify();
+}
+
+void PlaylistTests::randomSequences_data()
+{
+    QTest::addColumn<int>("steps");
+    QTest::addColumn<int>("maxBatch");
+
+    QTest::newRow("small batches") << 2000 << 4;
+    QTest::newRow("large batches") << 400 << 200;
+}
+
+void PlaylistTests::randomSequences()
+{
+    QFETCH(int, steps);
+    QFETCH(int, maxBatch);
+
+    for (int step = 0; step < steps; ++step) {
+        int total = expected.size();
+        int operation = random.bounded(total == 0 ? 1 : 5);
+
+        if (operation == 0) {
+            int row = random.bounded(total + 1);
+            QVector<SurahNode*> batch = createNodes(1 + random.bounded(maxBatch));
+            list.insertBatch(row, batch);
+            for (int i = 0; i < batch.size(); ++i) expected.insert(row + i, batch[i]);
+        }
+        else if (operation == 1) {
+            int row = random.bounded(total);
+            int count = 1 + random.bounded(qMin(maxBatch, total - row));
+            QVector<SurahNode*> removed = list.removeRange(row, count);
+            QVERIFY(removed == expected.mid(row, count));
+            expected.remove(row, count);
+            for (SurahNode* node : removed) list.destroyNode(node);
+        }
+        else if (operation == 2) {
+            int row = random.bounded(total);
+            int count = 1 + random.bounded(total - row);
+            int newRow = random.bounded(total - count + 1);
+            list.moveRange(row, count, newRow);
+            QVector<SurahNode*> block = expected.mid(row, count);
+            expected.remove(row, count);
+            for (int i = 0; i < block.size(); ++i) expected.insert(newRow + i, block[i]);
+        }
+        else if (operation == 3) {
+            QVector<int> oldRows(total);
+            for (int i = 0; i < total; ++i) oldRows[i] = i;
+            for (int i = total - 1; i > 0; --i) std::swap(oldRows[i], oldRows[random.bounded(i + 1)]);
+            list.permute(oldRows);
+            QVector<SurahNode*> permuted;
+            permuted.reserve(total);
+            for (int row : oldRows) permuted.append(expected[row]);
+            expected = permuted;
+        }
+        else {
+            int row = random.bounded(total);
+            SurahNode* node = list.removeAt(row);
+            QVERIFY(node == expected[row]);
+            expected.remove(row);
+            list.destroyNode(node);
+        }
+
+        verify();
+        if (QTest::currentTestFailed()) {
+            qWarning("step %d, operation %d", step, operation);
+            return;
+        }
+    }
+}
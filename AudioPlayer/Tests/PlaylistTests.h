@@ -0,0 +1,32 @@
+#pragma once
+#include <QObject>
+#include <QVector>
+#include <QRandomGenerator>
+#include "Playlist.h"
+
+// --- اختبارات الشجرة الضمنية في Playlist ---
+// سلاسل عشوائية من الإدراج والحذف والنقل وإعادة الترتيب، تُقارن بعد كل خطوة
+// بمصفوفة عادية تُطبق عليها نفس العمليات
+class PlaylistTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void insertBatchKeepsOrder();
+    void removeRangeKeepsOrder();
+    void moveRangeKeepsOrder();
+    void permuteKeepsOrder();
+    void randomSequences_data();
+    void randomSequences();
+
+private:
+    QVector<SurahNode*> createNodes(int count);
+    void verify();
+
+    Playlist list;
+    QVector<SurahNode*> expected;
+    QRandomGenerator random;
+    int nextFile = 0;
+};
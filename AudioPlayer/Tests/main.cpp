@@ -0,0 +1,21 @@
+#include "PlaylistTests.h"
+#include "EditJournalTests.h"
+#include <QCoreApplication>
+#include <QtTest/QtTest>
+
+// كل فئة اختبار تعمل بالتتابع، والنتيجة غير صفرية إن فشل أي اختبار
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    int status = 0;
+    {
+        PlaylistTests tests;
+        status |= QTest::qExec(&tests, argc, argv);
+    }
+    {
+        EditJournalTests tests;
+        status |= QTest::qExec(&tests, argc, argv);
+    }
+    return status;
+}